@@ -28,9 +28,12 @@ public:
     virtual ext::optional<Permissions> readFilePermissions(std::string const &path) const;
     virtual bool writeFilePermissions(std::string const &path, Permissions::Operation operation, Permissions permissions);
     virtual bool createFile(std::string const &path);
+    virtual bool readFileInfo(std::string const &path, uint64_t *size, uint64_t *modified) const;
+    virtual uint64_t currentTime() const;
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
     virtual bool copyFile(std::string const &from, std::string const &to);
+    virtual bool renameFile(std::string const &from, std::string const &to);
     virtual bool removeFile(std::string const &path);
 
 public:
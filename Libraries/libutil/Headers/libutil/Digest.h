@@ -0,0 +1,63 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_Digest_h
+#define __libutil_Digest_h
+
+#include <libutil/md5.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libutil {
+
+/*
+ * Computes an MD5 digest of data appended in pieces, formatted as
+ * lowercase hexadecimal.
+ */
+class Digest {
+private:
+    md5_state_t _state;
+
+public:
+    Digest();
+
+public:
+    /*
+     * Add data to the digest.
+     */
+    void append(uint8_t const *data, size_t size);
+    void append(std::string const &data);
+    void append(std::vector<uint8_t> const &data);
+
+    /*
+     * Add a string and its terminator, so that adjacent strings can't
+     * run together.
+     */
+    void appendTerminated(std::string const &data);
+
+public:
+    /*
+     * The digest of the data appended. Nothing can be appended after.
+     */
+    std::string finish();
+
+public:
+    /*
+     * The digest of a single piece of data.
+     */
+    static std::string Hex(std::string const &data);
+    static std::string Hex(std::vector<uint8_t> const &data);
+};
+
+}
+
+#endif  // !__libutil_Digest_h
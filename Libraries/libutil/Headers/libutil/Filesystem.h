@@ -13,6 +13,7 @@
 #include <libutil/Permissions.h>
 
 #include <functional>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <ext/optional>
@@ -83,6 +84,18 @@ public:
      */
     virtual bool createFile(std::string const &path) = 0;
 
+    /*
+     * Read the size of a file and when it was last modified, in
+     * nanoseconds since the Unix epoch.
+     */
+    virtual bool readFileInfo(std::string const &path, uint64_t *size, uint64_t *modified) const = 0;
+
+    /*
+     * The current time, comparable with modification times. A file modified
+     * after this returns has a modification time no earlier than it.
+     */
+    virtual uint64_t currentTime() const = 0;
+
     /*
      * Read from a file.
      */
@@ -93,11 +106,25 @@ public:
      */
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path) = 0;
 
+    /*
+     * Write to a file so that it appears with all of its contents or not at
+     * all, even if writing is interrupted or another process writes the same
+     * file at the same time. Writes to a temporary file next to the path,
+     * then renames it over the path.
+     */
+    virtual bool writeAtomic(std::vector<uint8_t> const &contents, std::string const &path);
+
     /*
      * Copy a file to a new path.
      */
     virtual bool copyFile(std::string const &from, std::string const &to);
 
+    /*
+     * Move a file to a new path, replacing any file already there. The
+     * replacement is atomic, so the new path never has partial contents.
+     */
+    virtual bool renameFile(std::string const &from, std::string const &to) = 0;
+
     /*
      * Delete a file.
      */
@@ -0,0 +1,141 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_Interned_h
+#define __libutil_Interned_h
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace libutil {
+
+/*
+ * An immutable, reference counted container value. Values are hash-consed:
+ * equal values share a single copy for as long as any reference to it is
+ * alive, so copying and comparing interned values is cheap.
+ *
+ * Converts implicitly to and from the underlying container, so it can be
+ * assigned from and passed wherever a `T const &` is expected.
+ */
+template<typename T, typename Hash>
+class Interned {
+private:
+    struct Table {
+        std::mutex                                              mutex;
+        std::unordered_multimap<size_t, std::weak_ptr<T const>> values;
+        size_t                                                  sweep = 1024;
+    };
+
+private:
+    std::shared_ptr<T const> _value;
+
+public:
+    Interned() :
+        _value(Empty())
+    {
+    }
+
+    Interned(T const &value) :
+        _value(Intern(value))
+    {
+    }
+
+    Interned(T &&value) :
+        _value(Intern(std::move(value)))
+    {
+    }
+
+    Interned(std::initializer_list<typename T::value_type> values) :
+        _value(Intern(T(values)))
+    {
+    }
+
+public:
+    T const &value() const
+    { return *_value; }
+    operator T const &() const
+    { return *_value; }
+
+public:
+    typename T::const_iterator begin() const
+    { return _value->begin(); }
+    typename T::const_iterator end() const
+    { return _value->end(); }
+    size_t size() const
+    { return _value->size(); }
+    bool empty() const
+    { return _value->empty(); }
+
+public:
+    /*
+     * Interned values are equal only if they share storage.
+     */
+    bool operator==(Interned const &rhs) const
+    { return _value == rhs._value; }
+    bool operator!=(Interned const &rhs) const
+    { return _value != rhs._value; }
+
+private:
+    static std::shared_ptr<T const> const &Empty()
+    {
+        static std::shared_ptr<T const> *empty = new std::shared_ptr<T const>(Intern(T()));
+        return *empty;
+    }
+
+    static Table *Values()
+    {
+        /* Shared by all values of this type; never destroyed to avoid exit ordering issues. */
+        static Table *table = new Table();
+        return table;
+    }
+
+    template<typename U>
+    static std::shared_ptr<T const> Intern(U &&value)
+    {
+        Table *table = Values();
+        size_t hash = Hash()(value);
+
+        std::lock_guard<std::mutex> lock(table->mutex);
+
+        auto range = table->values.equal_range(hash);
+        for (auto it = range.first; it != range.second;) {
+            if (std::shared_ptr<T const> existing = it->second.lock()) {
+                if (*existing == value) {
+                    return existing;
+                }
+                ++it;
+            } else {
+                /* No references left, drop the entry. */
+                it = table->values.erase(it);
+            }
+        }
+
+        if (table->values.size() >= table->sweep) {
+            /* Periodically drop all released values, so the table tracks the live set. */
+            for (auto it = table->values.begin(); it != table->values.end();) {
+                it = (it->second.expired() ? table->values.erase(it) : std::next(it));
+            }
+            table->sweep = std::max<size_t>(1024, table->values.size() * 2);
+        }
+
+        std::shared_ptr<T const> interned = std::make_shared<T const>(std::forward<U>(value));
+        table->values.insert({ hash, interned });
+        return interned;
+    }
+};
+
+}
+
+#endif  // !__libutil_Interned_h
@@ -0,0 +1,40 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __libutil_Parallel_h
+#define __libutil_Parallel_h
+
+#include <cstddef>
+#include <functional>
+
+namespace libutil {
+
+/*
+ * Runs independent pieces of work across a pool of worker threads. The
+ * threads are started on first use and shared by all later calls.
+ */
+struct Parallel {
+    /*
+     * The number of workers to use when not specified. This is the
+     * number of hardware threads, or one if that is not known.
+     */
+    static size_t DefaultWorkers();
+
+    /*
+     * Calls `function` once for each index in `[0, count)`, spread across
+     * at most `workers` threads, including the calling thread. Returns
+     * after all calls have finished. The order the calls are made in is
+     * not specified. Calls may be nested.
+     */
+    static void For(size_t count, std::function<void(size_t)> const &function, size_t workers = DefaultWorkers());
+};
+
+}
+
+#endif  // !__libutil_Parallel_h
@@ -24,6 +24,7 @@
 #include <libgen.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <time.h>
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #include <copyfile.h>
 #endif
@@ -471,6 +472,76 @@ createFile(std::string const &path)
 #endif
 }
 
+bool DefaultFilesystem::
+readFileInfo(std::string const &path, uint64_t *size, uint64_t *modified) const
+{
+#if _WIN32
+    WideString wide = StringToWideString(path);
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(wide.c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        return false;
+    }
+
+    /* File times are in 100ns intervals since 1601. */
+    uint64_t time = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    *size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    *modified = (time - UINT64_C(116444736000000000)) * 100;
+    return true;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) < 0) {
+        return false;
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+#if defined(__APPLE__)
+    struct timespec const &time = st.st_mtimespec;
+#else
+    struct timespec const &time = st.st_mtim;
+#endif
+    *size = static_cast<uint64_t>(st.st_size);
+    *modified = static_cast<uint64_t>(time.tv_sec) * UINT64_C(1000000000) + static_cast<uint64_t>(time.tv_nsec);
+    return true;
+#endif
+}
+
+uint64_t DefaultFilesystem::
+currentTime() const
+{
+#if _WIN32
+    FILETIME filetime;
+    GetSystemTimeAsFileTime(&filetime);
+
+    /* File times are in 100ns intervals since 1601. */
+    uint64_t time = (static_cast<uint64_t>(filetime.dwHighDateTime) << 32) | filetime.dwLowDateTime;
+    return (time - UINT64_C(116444736000000000)) * 100;
+#elif defined(__linux__)
+    /*
+     * Linux sets modification times from the coarse clock, which can be
+     * behind the precise clock by a few milliseconds.
+     */
+    struct timespec time;
+    clock_gettime(CLOCK_REALTIME_COARSE, &time);
+    return static_cast<uint64_t>(time.tv_sec) * UINT64_C(1000000000) + static_cast<uint64_t>(time.tv_nsec);
+#else
+    /*
+     * Some filesystems only store modification times in whole seconds, so
+     * round down to be no later than any of them.
+     */
+    struct timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+    return static_cast<uint64_t>(time.tv_sec) * UINT64_C(1000000000);
+#endif
+}
+
 bool DefaultFilesystem::
 read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext::optional<size_t> length) const
 {
@@ -661,6 +732,30 @@ copyFile(std::string const &from, std::string const &to)
 #endif
 }
 
+bool DefaultFilesystem::
+renameFile(std::string const &from, std::string const &to)
+{
+    if (this->type(from) != Type::File) {
+        return false;
+    }
+
+#if _WIN32
+    WideString fwide = StringToWideString(from);
+    WideString twide = StringToWideString(to);
+    if (!MoveFileExW(fwide.c_str(), twide.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        return false;
+    }
+
+    return true;
+#else
+    if (::rename(from.c_str(), to.c_str()) < 0) {
+        return false;
+    }
+
+    return true;
+#endif
+}
+
 bool DefaultFilesystem::
 removeFile(std::string const &path)
 {
@@ -873,18 +968,22 @@ createDirectory(std::string const &path, bool recursive)
             current = FSUtil::GetDirectoryName(current);
         }
 
-        /* Create intermediate directories. */
+        /* Create intermediate directories. Another process may create them concurrently. */
         while (!create.empty()) {
             std::string const &directory = create.top();
 
 #if _WIN32
             WideString wide = StringToWideString(directory);
             if (!CreateDirectoryW(wide.c_str(), nullptr)) {
-                return false;
+                if (GetLastError() != ERROR_ALREADY_EXISTS || this->type(directory) != Type::Directory) {
+                    return false;
+                }
             }
 #else
             if (::mkdir(directory.c_str(), mode) != 0) {
-                return false;
+                if (errno != EEXIST || this->type(directory) != Type::Directory) {
+                    return false;
+                }
             }
 #endif
 
@@ -0,0 +1,75 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/Digest.h>
+
+#include <iomanip>
+#include <sstream>
+
+using libutil::Digest;
+
+Digest::
+Digest()
+{
+    md5_init(&_state);
+}
+
+void Digest::
+append(uint8_t const *data, size_t size)
+{
+    md5_append(&_state, reinterpret_cast<md5_byte_t const *>(data), static_cast<int>(size));
+}
+
+void Digest::
+append(std::string const &data)
+{
+    append(reinterpret_cast<uint8_t const *>(data.data()), data.size());
+}
+
+void Digest::
+append(std::vector<uint8_t> const &data)
+{
+    append(data.data(), data.size());
+}
+
+void Digest::
+appendTerminated(std::string const &data)
+{
+    append(reinterpret_cast<uint8_t const *>(data.c_str()), data.size() + 1);
+}
+
+std::string Digest::
+finish()
+{
+    uint8_t digest[16];
+    md5_finish(&_state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t c : digest) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+    return ss.str();
+}
+
+std::string Digest::
+Hex(std::string const &data)
+{
+    Digest digest;
+    digest.append(data);
+    return digest.finish();
+}
+
+std::string Digest::
+Hex(std::vector<uint8_t> const &data)
+{
+    Digest digest;
+    digest.append(data);
+    return digest.finish();
+}
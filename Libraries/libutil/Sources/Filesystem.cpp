@@ -10,6 +10,8 @@
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
+#include <atomic>
+#include <random>
 #include <unordered_set>
 #include <sstream>
 
@@ -32,6 +34,31 @@ copyFile(std::string const &from, std::string const &to)
     return true;
 }
 
+/*
+ * A suffix for temporary files that is unique in this process, and very
+ * likely unique among other processes writing the same file.
+ */
+static std::string
+TemporarySuffix()
+{
+    static unsigned int const process = std::random_device()();
+    static std::atomic<uint64_t> counter(0);
+    return ".tmp." + std::to_string(process) + "." + std::to_string(counter++);
+}
+
+bool Filesystem::
+writeAtomic(std::vector<uint8_t> const &contents, std::string const &path)
+{
+    std::string temporary = path + TemporarySuffix();
+
+    if (!this->write(contents, temporary) || !this->renameFile(temporary, path)) {
+        this->removeFile(temporary);
+        return false;
+    }
+
+    return true;
+}
+
 bool Filesystem::
 copySymbolicLink(std::string const &from, std::string const &to)
 {
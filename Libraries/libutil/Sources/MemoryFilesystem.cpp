@@ -21,8 +21,9 @@ using libutil::FSUtil;
 
 MemoryFilesystem::Entry::
 Entry(std::string const &name, Type type) :
-    _name(name),
-    _type(type)
+    _name    (name),
+    _type    (type),
+    _modified(0)
 {
 }
 
@@ -73,10 +74,11 @@ Directory(std::string const &name, std::vector<Entry> const &children)
 MemoryFilesystem::
 MemoryFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
 #if _WIN32
-    _root(MemoryFilesystem::Entry::Directory("C:", entries))
+    _root (MemoryFilesystem::Entry::Directory("C:", entries)),
 #else
-    _root(MemoryFilesystem::Entry::Directory("", entries))
+    _root (MemoryFilesystem::Entry::Directory("", entries)),
 #endif
+    _clock(0)
 {
 }
 
@@ -270,7 +272,7 @@ writeDirectoryPermissions(std::string const &path, Permissions::Operation operat
 bool MemoryFilesystem::
 createFile(std::string const &path)
 {
-    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+    return WalkPath<MemoryFilesystem::Entry>(this, path, false, [this](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == Type::File) {
                 /* Exists as a file. */
@@ -282,6 +284,7 @@ createFile(std::string const &path)
         } else {
             /* Add empty file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, std::vector<uint8_t>());
+            file.modified() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(file));
             return &children->back();
@@ -289,6 +292,28 @@ createFile(std::string const &path)
     });
 }
 
+bool MemoryFilesystem::
+readFileInfo(std::string const &path, uint64_t *size, uint64_t *modified) const
+{
+    return WalkPath<MemoryFilesystem::Entry const>(this, path, false, [&](MemoryFilesystem::Entry const *parent, std::string const &name, MemoryFilesystem::Entry const *entry) -> MemoryFilesystem::Entry const * {
+        if (entry == nullptr || entry->type() != Type::File) {
+            return nullptr;
+        }
+
+        /* Modification times count writes, which is enough to detect changes. */
+        *size = entry->contents().size();
+        *modified = entry->modified();
+        return entry;
+    });
+}
+
+uint64_t MemoryFilesystem::
+currentTime() const
+{
+    /* The next write is the first one after now. */
+    return _clock + 1;
+}
+
 bool MemoryFilesystem::
 read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext::optional<size_t> length) const
 {
@@ -317,6 +342,7 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
             if (entry->type() == Type::File) {
                 /* Exists as a file, replace contents. */
                 entry->contents() = contents;
+                entry->modified() = ++_clock;
                 return entry;
             } else {
                 /* Exists already, but not as a file. */
@@ -325,6 +351,7 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
         } else {
             /* Add file. */
             MemoryFilesystem::Entry file = MemoryFilesystem::Entry::File(name, contents);
+            file.modified() = ++_clock;
             std::vector<MemoryFilesystem::Entry> *children = &parent->children();
             children->emplace_back(std::move(file));
             return &children->back();
@@ -338,6 +365,46 @@ copyFile(std::string const &from, std::string const &to)
     return Filesystem::copyFile(from, to);
 }
 
+bool MemoryFilesystem::
+renameFile(std::string const &from, std::string const &to)
+{
+    /* Can only replace files, in directories that exist. */
+    ext::optional<Type> toType = this->type(to);
+    if (this->type(from) != Type::File || (toType && toType != Type::File) || this->type(FSUtil::GetDirectoryName(to)) != Type::Directory) {
+        return false;
+    }
+
+    if (FSUtil::NormalizePath(from) == FSUtil::NormalizePath(to)) {
+        return true;
+    }
+
+    /* Take the file out of its directory, keeping its contents and modification time. */
+    ext::optional<MemoryFilesystem::Entry> file;
+    WalkPath<MemoryFilesystem::Entry>(this, from, false, [&file](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+        file = *entry;
+
+        std::vector<MemoryFilesystem::Entry> *children = &parent->children();
+        children->erase(std::remove_if(children->begin(), children->end(), [&](MemoryFilesystem::Entry const &entry) {
+            return (entry.name() == name);
+        }), children->end());
+        return parent;
+    });
+
+    /* Put it in place, replacing any existing file. */
+    return WalkPath<MemoryFilesystem::Entry>(this, to, false, [&file](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
+        file->name() = name;
+
+        if (entry != nullptr) {
+            *entry = std::move(*file);
+            return entry;
+        } else {
+            std::vector<MemoryFilesystem::Entry> *children = &parent->children();
+            children->emplace_back(std::move(*file));
+            return &children->back();
+        }
+    });
+}
+
 bool MemoryFilesystem::
 removeFile(std::string const &path)
 {
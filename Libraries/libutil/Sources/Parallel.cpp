@@ -0,0 +1,151 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <libutil/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using libutil::Parallel;
+
+namespace {
+
+/*
+ * A call to `For()` that threads from the pool can help with.
+ */
+struct Job {
+    size_t                             count;
+    std::function<void(size_t)> const *function;
+    std::atomic<size_t>                next;
+    size_t                             helpers;
+    size_t                             active;
+
+    Job(size_t count, std::function<void(size_t)> const *function, size_t helpers) :
+        count   (count),
+        function(function),
+        next    (0),
+        helpers (helpers),
+        active  (0)
+    {
+    }
+
+    /*
+     * Take the next index until none are left, so uneven amounts of
+     * work per index still spread across all of the threads.
+     */
+    void run()
+    {
+        for (size_t n = next++; n < count; n = next++) {
+            (*function)(n);
+        }
+    }
+};
+
+/*
+ * Threads waiting to help with jobs. Jobs are always run by their calling
+ * thread as well, so nested jobs finish even if every thread is busy.
+ */
+class Pool {
+private:
+    std::mutex              _mutex;
+    std::condition_variable _available;
+    std::condition_variable _finished;
+    std::deque<Job *>       _jobs;
+
+public:
+    explicit Pool(size_t threads)
+    {
+        for (size_t n = 0; n < threads; n++) {
+            std::thread(&Pool::work, this).detach();
+        }
+    }
+
+public:
+    void run(Job *job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _jobs.push_back(job);
+        }
+        _available.notify_all();
+
+        job->run();
+
+        /* All indices are taken; wait for helpers still running one. */
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = std::find(_jobs.begin(), _jobs.end(), job);
+        if (it != _jobs.end()) {
+            _jobs.erase(it);
+        }
+        _finished.wait(lock, [job] { return job->active == 0; });
+    }
+
+private:
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _available.wait(lock, [this] { return !_jobs.empty(); });
+
+            Job *job = _jobs.front();
+            job->active++;
+            if (--job->helpers == 0) {
+                _jobs.pop_front();
+            }
+
+            lock.unlock();
+            job->run();
+            lock.lock();
+
+            if (--job->active == 0) {
+                _finished.notify_all();
+            }
+        }
+    }
+};
+
+}
+
+/*
+ * The pool is never destroyed, as its threads may still be waiting for
+ * work when static destructors run at exit.
+ */
+static Pool *
+SharedPool()
+{
+    static Pool *pool = new Pool(Parallel::DefaultWorkers() - 1);
+    return pool;
+}
+
+size_t Parallel::
+DefaultWorkers()
+{
+    unsigned int concurrency = std::thread::hardware_concurrency();
+    return (concurrency > 0 ? concurrency : 1);
+}
+
+void Parallel::
+For(size_t count, std::function<void(size_t)> const &function, size_t workers)
+{
+    workers = std::min(workers, count);
+    if (workers <= 1) {
+        for (size_t n = 0; n < count; n++) {
+            function(n);
+        }
+        return;
+    }
+
+    /* The calling thread is one of the workers. */
+    Job job(count, &function, workers - 1);
+    SharedPool()->run(&job);
+}
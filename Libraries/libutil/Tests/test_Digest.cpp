@@ -0,0 +1,33 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/Digest.h>
+
+using libutil::Digest;
+
+TEST(Digest, Hex)
+{
+    EXPECT_EQ("d41d8cd98f00b204e9800998ecf8427e", Digest::Hex(std::string()));
+    EXPECT_EQ("900150983cd24fb0d6963f7d28e17f72", Digest::Hex(std::string("abc")));
+    EXPECT_EQ("900150983cd24fb0d6963f7d28e17f72", Digest::Hex(std::vector<uint8_t>({ 'a', 'b', 'c' })));
+}
+
+TEST(Digest, Append)
+{
+    Digest pieces;
+    pieces.append(std::string("a"));
+    pieces.append(std::string("bc"));
+    EXPECT_EQ(Digest::Hex(std::string("abc")), pieces.finish());
+
+    Digest terminated;
+    terminated.appendTerminated("ab");
+    terminated.appendTerminated("c");
+    EXPECT_EQ(Digest::Hex(std::string("ab\0c\0", 5)), terminated.finish());
+}
@@ -0,0 +1,51 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/Interned.h>
+
+#include <string>
+#include <vector>
+
+struct StringsHash {
+    size_t operator()(std::vector<std::string> const &strings) const
+    {
+        size_t hash = strings.size();
+        for (std::string const &string : strings) {
+            hash = hash * 31 + std::hash<std::string>()(string);
+        }
+        return hash;
+    }
+};
+
+typedef libutil::Interned<std::vector<std::string>, StringsHash> Strings;
+
+TEST(Interned, Shared)
+{
+    Strings a = std::vector<std::string>({ "-c", "input.c" });
+    Strings b = { "-c", "input.c" };
+    Strings c = { "-c", "other.c" };
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(&a.value(), &b.value());
+    EXPECT_NE(a, c);
+
+    std::vector<std::string> const &value = b;
+    EXPECT_EQ(std::vector<std::string>({ "-c", "input.c" }), value);
+}
+
+TEST(Interned, Empty)
+{
+    Strings a;
+    Strings b = std::vector<std::string>();
+
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.begin(), a.end());
+}
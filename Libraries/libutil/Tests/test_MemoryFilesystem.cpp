@@ -10,6 +10,8 @@
 #include <gtest/gtest.h>
 #include <libutil/MemoryFilesystem.h>
 
+#include <algorithm>
+
 using libutil::MemoryFilesystem;
 using libutil::Filesystem;
 
@@ -164,6 +166,30 @@ TEST(MemoryFilesystem, Read)
     EXPECT_EQ(contents, Contents(""));
 }
 
+TEST(MemoryFilesystem, ReadFileInfo)
+{
+    auto filesystem = BasicFilesystem();
+    uint64_t size = 0;
+    uint64_t modified = 0;
+
+    /* Read file info. */
+    EXPECT_TRUE(filesystem.readFileInfo(filesystem.path("dir1/file2"), &size, &modified));
+    EXPECT_EQ(4, size);
+
+    /* Writing changes the modification time, even with the same size. */
+    uint64_t written = 0;
+    EXPECT_TRUE(filesystem.write(Contents("bbbb"), filesystem.path("dir1/file2")));
+    EXPECT_TRUE(filesystem.readFileInfo(filesystem.path("dir1/file2"), &size, &written));
+    EXPECT_EQ(4, size);
+    EXPECT_NE(modified, written);
+
+    /* Can't read directory. */
+    EXPECT_FALSE(filesystem.readFileInfo(filesystem.path("dir1"), &size, &modified));
+
+    /* Can't read nonexistent file. */
+    EXPECT_FALSE(filesystem.readFileInfo(filesystem.path("invalid"), &size, &modified));
+}
+
 TEST(MemoryFilesystem, Write)
 {
     auto filesystem = BasicFilesystem();
@@ -221,6 +247,66 @@ TEST(MemoryFilesystem, CopyFile)
     EXPECT_EQ(contents, Contents("one"));
 }
 
+TEST(MemoryFilesystem, RenameFile)
+{
+    std::vector<uint8_t> contents;
+    auto filesystem = BasicFilesystem();
+
+    /* Must rename a file, to a real path that isn't a directory. */
+    EXPECT_FALSE(filesystem.renameFile(filesystem.path("invalid"), filesystem.path("renamed")));
+    EXPECT_FALSE(filesystem.renameFile(filesystem.path("dir1"), filesystem.path("renamed")));
+    EXPECT_FALSE(filesystem.renameFile(filesystem.path("file1"), filesystem.path("invalid/file1")));
+    EXPECT_FALSE(filesystem.renameFile(filesystem.path("file1"), filesystem.path("dir2/dir3")));
+    EXPECT_TRUE(filesystem.exists(filesystem.path("file1")));
+
+    /* Can rename to a new path. */
+    EXPECT_TRUE(filesystem.renameFile(filesystem.path("file1"), filesystem.path("renamed")));
+    EXPECT_FALSE(filesystem.exists(filesystem.path("file1")));
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("renamed")));
+    EXPECT_EQ(contents, Contents("one"));
+
+    /* Can rename over an existing file. */
+    contents.clear();
+    EXPECT_TRUE(filesystem.renameFile(filesystem.path("renamed"), filesystem.path("dir1/file2")));
+    EXPECT_FALSE(filesystem.exists(filesystem.path("renamed")));
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("dir1/file2")));
+    EXPECT_EQ(contents, Contents("one"));
+}
+
+TEST(MemoryFilesystem, WriteAtomic)
+{
+    std::vector<uint8_t> contents;
+    auto filesystem = BasicFilesystem();
+
+    /* Must write to a real path that isn't a directory. */
+    EXPECT_FALSE(filesystem.writeAtomic(Contents("new"), filesystem.path("invalid/file1")));
+    EXPECT_FALSE(filesystem.writeAtomic(Contents("new"), filesystem.path("dir2/dir3")));
+
+    /* Can write a new file, and replace an existing file. */
+    EXPECT_TRUE(filesystem.writeAtomic(Contents("new"), filesystem.path("written")));
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("written")));
+    EXPECT_EQ(contents, Contents("new"));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.writeAtomic(Contents("replaced"), filesystem.path("dir1/file2")));
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("dir1/file2")));
+    EXPECT_EQ(contents, Contents("replaced"));
+
+    /* No temporary files are left behind, even after failing. */
+    std::vector<std::string> files;
+    EXPECT_TRUE(filesystem.readDirectory(filesystem.path("dir2"), false, [&](std::string const &name) {
+        files.push_back(name);
+    }));
+    std::sort(files.begin(), files.end());
+    EXPECT_EQ(std::vector<std::string>({ "dir3", "file2" }), files);
+
+    files.clear();
+    EXPECT_TRUE(filesystem.readDirectory(filesystem.path("dir1"), false, [&](std::string const &name) {
+        files.push_back(name);
+    }));
+    EXPECT_EQ(std::vector<std::string>({ "file2" }), files);
+}
+
 TEST(MemoryFilesystem, RemoveFile)
 {
     auto filesystem = BasicFilesystem();
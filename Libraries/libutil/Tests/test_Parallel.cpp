@@ -0,0 +1,53 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/Parallel.h>
+
+#include <atomic>
+#include <vector>
+
+using libutil::Parallel;
+
+TEST(Parallel, For)
+{
+    std::vector<int> values = std::vector<int>(1000, 0);
+    Parallel::For(values.size(), [&](size_t n) {
+        values[n] += static_cast<int>(n);
+    }, 4);
+
+    for (size_t n = 0; n < values.size(); n++) {
+        EXPECT_EQ(static_cast<int>(n), values[n]);
+    }
+}
+
+TEST(Parallel, Empty)
+{
+    std::atomic<size_t> calls(0);
+    Parallel::For(0, [&](size_t n) {
+        calls++;
+    }, 4);
+    EXPECT_EQ(0, calls);
+
+    Parallel::For(1, [&](size_t n) {
+        calls++;
+    }, 4);
+    EXPECT_EQ(1, calls);
+}
+
+TEST(Parallel, Nested)
+{
+    std::atomic<size_t> calls(0);
+    Parallel::For(8, [&](size_t n) {
+        Parallel::For(100, [&](size_t m) {
+            calls++;
+        }, 4);
+    }, 4);
+    EXPECT_EQ(800, calls);
+}
@@ -15,6 +15,7 @@
 #include <pbxbuild/Build/Environment.h>
 #include <pbxbuild/Target/Environment.h>
 
+#include <mutex>
 #include <ext/optional>
 
 namespace pbxbuild {
@@ -36,7 +37,18 @@ private:
     std::vector<pbxsetting::Level>    _overrideLevels;
 
 private:
-    std::shared_ptr<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>> _targetEnvironments;
+    /*
+     * Target environments created so far, including targets that failed.
+     * Shared between copies of the context, and safe to use from multiple
+     * threads at once.
+     */
+    struct TargetEnvironments {
+        std::mutex mutex;
+        std::unordered_map<pbxproj::PBX::Target::shared_ptr, ext::optional<Target::Environment>> environments;
+    };
+
+private:
+    std::shared_ptr<TargetEnvironments> _targetEnvironments;
 
 public:
     Context(
@@ -112,6 +124,14 @@ public:
     ext::optional<Target::Environment>
     targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const;
 
+    /*
+     * Create the computed environments for a set of targets, in parallel.
+     * Later calls to `targetEnvironment()` for these targets are then only
+     * a lookup.
+     */
+    void
+    createTargetEnvironments(Build::Environment const &buildEnvironment, std::vector<pbxproj::PBX::Target::shared_ptr> const &targets) const;
+
 public:
     /*
      * Finds a target by identifier within a project.
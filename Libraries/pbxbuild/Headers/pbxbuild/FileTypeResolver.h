@@ -21,16 +21,66 @@ namespace pbxbuild {
  * Determines the file type of a file.
  */
 class FileTypeResolver {
+public:
+    /*
+     * What is on disk at a path, as far as determining its file type. The
+     * start of the file is read once, long enough for any magic word, and
+     * shared by all file types checked.
+     */
+    class Sniff {
+    private:
+        bool                                _readable;
+        bool                                _folder;
+        ext::optional<std::vector<uint8_t>> _header;
+
+    public:
+        Sniff(bool readable, bool folder, ext::optional<std::vector<uint8_t>> const &header);
+
+    public:
+        /*
+         * If the path exists and is readable.
+         */
+        bool readable() const
+        { return _readable; }
+
+        /*
+         * If the path is a directory.
+         */
+        bool folder() const
+        { return _folder; }
+
+        /*
+         * The start of the file, if it has been read.
+         */
+        ext::optional<std::vector<uint8_t>> const &header() const
+        { return _header; }
+
+    public:
+        /*
+         * Sniff a file path, reading as much of the file as the magic words
+         * of the file types in the domains need.
+         */
+        static Sniff
+        Read(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath);
+
+        /*
+         * Sniff many file paths in parallel.
+         */
+        static std::vector<Sniff>
+        Read(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::vector<std::string> const &filePaths);
+    };
+
 private:
     FileTypeResolver();
     ~FileTypeResolver();
 
 public:
     /*
-     * Determine the file type of a file path.
+     * Determine the file type of a file path. If the path has already been
+     * sniffed, pass that in to avoid checking the filesystem again.
      */
     static pbxspec::PBX::FileType::shared_ptr
-    Resolve(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath);
+    Resolve(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath, Sniff const *sniff = nullptr);
 
     /*
      * Determine the file type of a file reference. If a file reference is available, use
@@ -38,14 +88,22 @@ public:
      * the automatically determined file type from the file path.
      */
     static pbxspec::PBX::FileType::shared_ptr
-    Resolve(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath);
+    Resolve(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath, Sniff const *sniff = nullptr);
 
     /*
      * Determine the file type of a version group. Uses the explicit file type or falls back
      * to autodetecting the file type from the path provided.
      */
     static pbxspec::PBX::FileType::shared_ptr
-    Resolve(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath);
+    Resolve(libutil::Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath, Sniff const *sniff = nullptr);
+
+public:
+    /*
+     * If determining the file type of a file reference needs to look at
+     * the file on disk, and so could use a sniff of its path.
+     */
+    static bool
+    NeedsSniff(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference);
 };
 
 }
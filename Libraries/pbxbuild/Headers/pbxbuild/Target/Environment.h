@@ -17,6 +17,8 @@
 #include <xcsdk/SDK/Target.h>
 #include <xcsdk/SDK/Toolchain.h>
 
+#include <map>
+#include <mutex>
 #include <ext/optional>
 
 namespace pbxbuild {
@@ -53,6 +55,17 @@ private:
     std::string                                    _workingDirectory;
     std::unordered_map<pbxproj::PBX::BuildFile::shared_ptr, std::string> _buildFileDisambiguation;
 
+private:
+    /*
+     * Environments specialized for each variant and architecture, created
+     * as they are first needed. Shared between copies of the environment.
+     */
+    struct VariantArchitectureEnvironments {
+        std::mutex mutex;
+        std::map<std::pair<std::string, std::string>, pbxsetting::Environment> environments;
+    };
+    std::shared_ptr<VariantArchitectureEnvironments> _variantArchitectureEnvironments;
+
 public:
     Environment(
         xcsdk::SDK::Target::shared_ptr const &sdk,
@@ -142,6 +155,15 @@ public:
     std::vector<std::string> const &architectures() const
     { return _architectures; }
 
+    /*
+     * The build setting environment for building a variant and architecture
+     * of the target. Conditional settings are filtered for the target's SDK,
+     * the variant and the architecture once, when the environment is first
+     * requested, rather than on each lookup.
+     */
+    pbxsetting::Environment const &
+    variantArchitectureEnvironment(std::string const &variant, std::string const &arch) const;
+
 public:
     /*
      * The working directory the target should be built in.
@@ -156,6 +178,19 @@ public:
     std::unordered_map<pbxproj::PBX::BuildFile::shared_ptr, std::string> const &buildFileDisambiguation() const
     { return _buildFileDisambiguation; }
 
+public:
+    /*
+     * Build settings describing the variant being built.
+     */
+    static pbxsetting::Level
+    VariantLevel(std::string const &variant);
+
+    /*
+     * Build settings describing the architecture being built.
+     */
+    static pbxsetting::Level
+    ArchitectureLevel(std::string const &arch);
+
 public:
     /*
      * Create a target environment for a specific build of a target.
@@ -12,9 +12,14 @@
 
 #include <pbxspec/Manager.h>
 #include <pbxspec/PBX/Compiler.h>
+#include <pbxbuild/Tool/Invocation.h>
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace pbxsetting { class Environment; }
@@ -28,9 +33,35 @@ class PrecompiledHeaderInfo;
 class SearchPaths;
 
 class ClangResolver {
+private:
+    /*
+     * The part of a compile invocation shared by every source file with
+     * the same variant, architecture, and file type in a target.
+     */
+    struct SourcePrefix {
+        std::string                            executable;
+        Tool::Invocation::SharedArguments      arguments;
+        size_t                                 dialectOffset;
+        Tool::Invocation::Environment          environment;
+        std::vector<std::string>               linkerArgs;
+        std::string                            prefixHeaderFile;
+        bool                                   precompilePrefixHeader;
+        std::shared_ptr<PrecompiledHeaderInfo> precompiledHeaderInfo;
+        std::vector<std::string>               notUsedInPrecompsArguments;
+    };
+
 private:
     pbxspec::PBX::Compiler::shared_ptr _compiler;
 
+private:
+    /*
+     * Prefixes by variant, architecture, and file type. Resolving is const,
+     * so the cache is guarded in case a resolver is used from many threads.
+     */
+    typedef std::tuple<std::string, std::string, std::string> SourcePrefixKey;
+    mutable std::mutex                                               _sourcePrefixesMutex;
+    mutable std::map<SourcePrefixKey, std::shared_ptr<SourcePrefix>> _sourcePrefixes;
+
 public:
     ClangResolver(pbxspec::PBX::Compiler::shared_ptr const &compiler);
     ~ClangResolver();
@@ -46,6 +77,13 @@ public:
         pbxsetting::Environment const &environment,
         PrecompiledHeaderInfo const &precompiledHeaderInfo) const;
 
+private:
+    std::shared_ptr<SourcePrefix> sourcePrefix(
+        Tool::Context *toolContext,
+        pbxsetting::Environment const &environment,
+        Tool::Input const &input,
+        std::string const &output) const;
+
 public:
     pbxspec::PBX::Compiler::shared_ptr const &compiler() const
     { return _compiler; }
@@ -0,0 +1,158 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxbuild_Tool_CompiledOptions_h
+#define __pbxbuild_Tool_CompiledOptions_h
+
+#include <pbxbuild/Tool/Condition.h>
+#include <pbxspec/PBX/FileType.h>
+#include <pbxspec/PBX/PropertyOption.h>
+#include <pbxspec/PBX/Tool.h>
+#include <pbxsetting/Value.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <ext/optional>
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * A tool's property options, pre-processed for generating arguments. Everything
+ * that depends only on the specification (conditions, argument templates, and
+ * the architecture and file type filters) is parsed once here rather than each
+ * time the options are evaluated for an input.
+ */
+class CompiledOptions {
+public:
+    typedef std::shared_ptr<CompiledOptions const> shared_ptr;
+
+public:
+    /*
+     * Argument templates keyed on the value of the option's setting, as used
+     * by `CommandLineArgs` and `AdditionalLinkerArgs`.
+     */
+    class Arguments {
+    private:
+        ext::optional<std::vector<pbxsetting::Value>>                    _always;
+        std::unordered_map<std::string, std::vector<pbxsetting::Value>> _values;
+        ext::optional<std::vector<pbxsetting::Value>>                    _otherwise;
+
+    public:
+        Arguments();
+        explicit Arguments(plist::Object const *arguments);
+
+    public:
+        /*
+         * The argument templates to use for a setting value, if any.
+         */
+        std::vector<pbxsetting::Value> const *
+        find(std::string const &value) const;
+    };
+
+    /*
+     * A single compiled property option.
+     */
+    class Option {
+    public:
+        typedef std::vector<std::vector<pbxsetting::Value>> ValueArguments;
+
+    private:
+        pbxspec::PBX::PropertyOption::shared_ptr        _option;
+        bool                                            _boolean;
+        bool                                            _list;
+
+    private:
+        ext::optional<Tool::Condition>                  _condition;
+        ext::optional<Tool::Condition>                  _commandLineCondition;
+        ext::optional<std::unordered_set<std::string>>  _architectures;
+        ext::optional<std::unordered_set<std::string>>  _fileTypes;
+
+    private:
+        std::vector<pbxsetting::Value>                  _flagArguments;
+        ext::optional<pbxsetting::Value>                _prefixArgument;
+        std::unordered_map<std::string, ValueArguments> _valueArguments;
+        Arguments                                       _commandLineArgs;
+        Arguments                                       _additionalLinkerArgs;
+
+    public:
+        explicit Option(pbxspec::PBX::PropertyOption::shared_ptr const &option);
+
+    public:
+        pbxspec::PBX::PropertyOption::shared_ptr const &option() const
+        { return _option; }
+        bool boolean() const
+        { return _boolean; }
+        bool list() const
+        { return _list; }
+
+    public:
+        ext::optional<Tool::Condition> const &condition() const
+        { return _condition; }
+        ext::optional<Tool::Condition> const &commandLineCondition() const
+        { return _commandLineCondition; }
+
+    public:
+        /*
+         * If the option applies for an architecture and file type. A null
+         * file type always matches, as does an option without a filter.
+         */
+        bool matchesArchitecture(std::string const &architecture) const;
+        bool matchesFileType(pbxspec::PBX::FileType::shared_ptr const &fileType) const;
+
+    public:
+        /*
+         * The command line flag followed by the value, for non-boolean options.
+         */
+        std::vector<pbxsetting::Value> const &flagArguments() const
+        { return _flagArguments; }
+        /*
+         * The prefix flag joined with the value into one argument.
+         */
+        ext::optional<pbxsetting::Value> const &prefixArgument() const
+        { return _prefixArgument; }
+        /*
+         * Arguments from `Values` and `AllowedValues`, in order, for a value.
+         */
+        ValueArguments const *
+        valueArguments(std::string const &value) const;
+        Arguments const &commandLineArgs() const
+        { return _commandLineArgs; }
+        Arguments const &additionalLinkerArgs() const
+        { return _additionalLinkerArgs; }
+    };
+
+private:
+    std::vector<Option> _options;
+
+public:
+    CompiledOptions(
+        std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
+        std::unordered_set<std::string> const &deletedSettings = std::unordered_set<std::string>());
+
+public:
+    std::vector<Option> const &options() const
+    { return _options; }
+
+public:
+    /*
+     * The compiled options for a tool. Compiled once per tool and shared
+     * between every invocation of that tool.
+     */
+    static CompiledOptions::shared_ptr
+    Shared(pbxspec::PBX::Tool::shared_ptr const &tool);
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_CompiledOptions_h
@@ -0,0 +1,86 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxbuild_Tool_Condition_h
+#define __pbxbuild_Tool_Condition_h
+
+#include <pbxsetting/Value.h>
+
+#include <string>
+#include <vector>
+#include <ext/optional>
+
+namespace pbxsetting { class Environment; }
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * A parsed condition expression, as used by the `Condition` and
+ * `CommandLineCondition` keys of property options. Supports:
+ *
+ *  - `&&` and `||`, evaluated left to right with short-circuiting.
+ *  - `!` to negate and parentheses for grouping.
+ *  - `==` and `!=` to compare two values as strings.
+ *  - Values, either bare or in single or double quotes, which can
+ *    include setting references like `$(SETTING)`.
+ *
+ * A value on its own is true unless it expands to exactly `NO`, so empty
+ * and unrecognized values are true.
+ */
+class Condition {
+private:
+    enum class Operator {
+        Value,
+        Equal,
+        NotEqual,
+        Not,
+        And,
+        Or,
+    };
+
+    struct Node {
+        Operator          op;
+        size_t            lhs;
+        size_t            rhs;
+        pbxsetting::Value value;
+    };
+
+private:
+    class Parser;
+
+private:
+    std::vector<Node> _nodes;
+    size_t            _root;
+
+private:
+    Condition(std::vector<Node> const &nodes, size_t root);
+
+public:
+    /*
+     * Evaluate the condition against an environment.
+     */
+    bool evaluate(pbxsetting::Environment const &environment) const;
+
+private:
+    bool evaluate(pbxsetting::Environment const &environment, size_t index) const;
+
+public:
+    /*
+     * Parse a condition expression. Returns nothing if the expression
+     * is not valid.
+     */
+    static ext::optional<Condition>
+    Parse(std::string const &expression);
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_Condition_h
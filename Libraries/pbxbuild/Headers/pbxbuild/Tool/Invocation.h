@@ -11,7 +11,11 @@
 #define __pbxbuild_Tool_Invocation_h
 
 #include <dependency/DependencyInfoFormat.h>
+#include <libutil/Interned.h>
 
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -21,6 +25,104 @@ namespace pbxbuild {
 namespace Tool {
 
 class Invocation {
+public:
+    struct ArgumentsHash {
+        size_t operator()(std::vector<std::string> const &arguments) const;
+    };
+
+    struct EnvironmentHash {
+        size_t operator()(std::unordered_map<std::string, std::string> const &environment) const;
+    };
+
+    /*
+     * Argument lists shared by many invocations, such as the arguments for
+     * every compile in a target, and environments, which are usually the
+     * same across many invocations, are interned to share storage.
+     */
+    typedef libutil::Interned<std::vector<std::string>, ArgumentsHash> SharedArguments;
+    typedef libutil::Interned<std::unordered_map<std::string, std::string>, EnvironmentHash> Environment;
+
+    /*
+     * The arguments for an invocation: a prefix shared with other invocations,
+     * followed by the arguments for just this invocation. Assigning a plain
+     * list of arguments stores it unshared, without interning.
+     */
+    class Arguments {
+    public:
+        class const_iterator {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef std::string               value_type;
+            typedef std::ptrdiff_t            difference_type;
+            typedef std::string const        *pointer;
+            typedef std::string const        &reference;
+
+        private:
+            Arguments const *_arguments;
+            size_t           _index;
+
+        public:
+            const_iterator(Arguments const *arguments, size_t index) :
+                _arguments(arguments),
+                _index    (index)
+            {
+            }
+
+        public:
+            reference operator*() const
+            { return (*_arguments)[_index]; }
+            pointer operator->() const
+            { return &(*_arguments)[_index]; }
+            const_iterator &operator++()
+            { _index++; return *this; }
+            const_iterator operator++(int)
+            { const_iterator previous = *this; _index++; return previous; }
+
+        public:
+            bool operator==(const_iterator const &rhs) const
+            { return _arguments == rhs._arguments && _index == rhs._index; }
+            bool operator!=(const_iterator const &rhs) const
+            { return !(*this == rhs); }
+        };
+
+    private:
+        SharedArguments          _prefix;
+        std::vector<std::string> _suffix;
+
+    public:
+        Arguments();
+        Arguments(std::vector<std::string> const &arguments);
+        Arguments(std::vector<std::string> &&arguments);
+        Arguments(std::initializer_list<std::string> arguments);
+        Arguments(SharedArguments const &prefix, std::vector<std::string> const &suffix);
+
+    public:
+        SharedArguments const &prefix() const
+        { return _prefix; }
+        std::vector<std::string> const &suffix() const
+        { return _suffix; }
+
+    public:
+        std::string const &operator[](size_t index) const
+        { return (index < _prefix.size() ? _prefix.value()[index] : _suffix[index - _prefix.size()]); }
+        size_t size() const
+        { return _prefix.size() + _suffix.size(); }
+        bool empty() const
+        { return _prefix.empty() && _suffix.empty(); }
+
+    public:
+        const_iterator begin() const
+        { return const_iterator(this, 0); }
+        const_iterator end() const
+        { return const_iterator(this, size()); }
+
+    public:
+        /*
+         * Copy all of the arguments into a single list.
+         */
+        std::vector<std::string> value() const;
+    };
+
 public:
     class DependencyInfo {
     private:
@@ -87,8 +189,8 @@ public:
 
 private:
     ext::optional<Executable>                    _executable;
-    std::vector<std::string>                     _arguments;
-    std::unordered_map<std::string, std::string> _environment;
+    Arguments                                    _arguments;
+    Environment                                  _environment;
     std::string                                  _workingDirectory;
 
 private:
@@ -123,19 +225,19 @@ public:
 public:
     ext::optional<Executable> const &executable() const
     { return _executable; }
-    std::vector<std::string> const &arguments() const
+    Arguments const &arguments() const
     { return _arguments; }
     std::unordered_map<std::string, std::string> const &environment() const
-    { return _environment; }
+    { return _environment.value(); }
     std::string const &workingDirectory() const
     { return _workingDirectory; }
 
 public:
     ext::optional<Executable> &executable()
     { return _executable; }
-    std::vector<std::string> &arguments()
+    Arguments &arguments()
     { return _arguments; }
-    std::unordered_map<std::string, std::string> &environment()
+    Environment &environment()
     { return _environment; }
     std::string &workingDirectory()
     { return _workingDirectory; }
@@ -10,6 +10,7 @@
 #ifndef __pbxbuild_Tool_OptionsResult_h
 #define __pbxbuild_Tool_OptionsResult_h
 
+#include <pbxbuild/Tool/CompiledOptions.h>
 #include <pbxspec/PBX/FileType.h>
 #include <pbxspec/PBX/PropertyOption.h>
 
@@ -50,6 +51,12 @@ public:
         pbxspec::PBX::FileType::shared_ptr const &fileType,
         std::unordered_set<std::string> const &deletedSettings = std::unordered_set<std::string>());
 
+    static OptionsResult Create(
+        pbxsetting::Environment const &environment,
+        std::string const &workingDirectory,
+        Tool::CompiledOptions const &options,
+        pbxspec::PBX::FileType::shared_ptr const &fileType);
+
     static OptionsResult Create(
         Tool::Environment const &toolEnvironment,
         std::string const &workingDirectory,
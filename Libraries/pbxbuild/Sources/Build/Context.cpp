@@ -8,10 +8,12 @@
  */
 
 #include <pbxbuild/Build/Context.h>
+#include <libutil/Parallel.h>
 
 namespace Build = pbxbuild::Build;
 namespace Target = pbxbuild::Target;
 using pbxbuild::WorkspaceContext;
+using libutil::Parallel;
 
 Build::Context::
 Context(
@@ -30,23 +32,38 @@ Context(
     _configuration       (configuration),
     _defaultConfiguration(defaultConfiguration),
     _overrideLevels      (overrideLevels),
-    _targetEnvironments  (std::make_shared<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>>())
+    _targetEnvironments  (std::make_shared<TargetEnvironments>())
 {
 }
 
 ext::optional<pbxbuild::Target::Environment> Build::Context::
 targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const
 {
-    auto TEI = _targetEnvironments->find(target);
-    if (TEI != _targetEnvironments->end()) {
-        return TEI->second;
-    } else {
-        ext::optional<Target::Environment> targetEnvironment = Target::Environment::Create(buildEnvironment, *this, target);
-        if (targetEnvironment) {
-            _targetEnvironments->insert(std::make_pair(target, *targetEnvironment));
+    {
+        std::lock_guard<std::mutex> lock(_targetEnvironments->mutex);
+
+        auto TEI = _targetEnvironments->environments.find(target);
+        if (TEI != _targetEnvironments->environments.end()) {
+            return TEI->second;
         }
-        return targetEnvironment;
     }
+
+    /*
+     * Not locked while creating, so targets can be created concurrently. If
+     * the same target is created twice at once, the first one is kept.
+     */
+    ext::optional<Target::Environment> targetEnvironment = Target::Environment::Create(buildEnvironment, *this, target);
+
+    std::lock_guard<std::mutex> lock(_targetEnvironments->mutex);
+    return _targetEnvironments->environments.insert(std::make_pair(target, targetEnvironment)).first->second;
+}
+
+void Build::Context::
+createTargetEnvironments(Build::Environment const &buildEnvironment, std::vector<pbxproj::PBX::Target::shared_ptr> const &targets) const
+{
+    Parallel::For(targets.size(), [&](size_t n) {
+        (void)targetEnvironment(buildEnvironment, targets[n]);
+    });
 }
 
 pbxproj::PBX::Target::shared_ptr Build::Context::
@@ -47,6 +47,13 @@ Default(process::User const *user, process::Context const *processContext, Files
         return ext::nullopt;
     }
 
+    /*
+     * Reuse specification files parsed by earlier runs with this developer root.
+     */
+    if (ext::optional<std::string> home = user->userHomeDirectory()) {
+        specManager->loadCache(filesystem, pbxspec::Manager::CachePath(*home + "/.xcbuild/Caches", *developerRoot));
+    }
+
     /*
      * Register global build rules.
      */
@@ -11,10 +11,14 @@
 #include <pbxbuild/DirectedGraph.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/Parallel.h>
 #include <libutil/Strings.h>
 #include <libutil/Wildcard.h>
 
-#include <cassert>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 
 using pbxbuild::FileTypeResolver;
 using pbxbuild::DirectedGraph;
@@ -38,146 +42,412 @@ SortedFileTypes(std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes
     return graph.ordered();
 }
 
-pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
-Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath)
+static std::string
+LowercaseString(std::string const &string)
 {
-    bool isReadable = filesystem->isReadable(filePath);
-    bool isFolder = isReadable && filesystem->type(filePath) == Filesystem::Type::Directory;
+    std::string result = string;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
 
-    std::string fileExtension = FSUtil::GetFileExtension(filePath);
-    std::string fileName = FSUtil::GetBaseName(filePath);
+namespace {
 
-    std::vector<uint8_t> fileContents;
+/*
+ * Finds the file types that could match a path, without checking every
+ * file type. Types are identified by their index in the sorted types.
+ */
+class FileTypeMatcher {
+private:
+    struct PrefixNode {
+        std::map<char, size_t> children;
+        std::vector<size_t>    fileTypes;
+    };
+
+private:
+    bool                                                 _valid;
+    std::vector<pbxspec::PBX::FileType::shared_ptr>      _fileTypes;
+    std::unordered_map<std::string, std::vector<size_t>> _extensions;
+    std::vector<PrefixNode>                              _prefixes;
+    std::vector<size_t>                                  _patterns;
+    std::vector<size_t>                                  _remaining;
+    size_t                                               _headerLength;
+
+public:
+    explicit FileTypeMatcher(std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes);
+
+public:
+    /*
+     * If the file types could be ordered.
+     */
+    bool valid() const
+    { return _valid; }
+
+    /*
+     * All file types, more specific types first.
+     */
+    std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes() const
+    { return _fileTypes; }
+
+    /*
+     * The length of the longest magic word.
+     */
+    size_t headerLength() const
+    { return _headerLength; }
+
+public:
+    /*
+     * The indexes of the file types that could match, in order. Any type
+     * not included can't match.
+     */
+    std::vector<size_t> candidates(std::string const &fileName, std::string const &fileExtension) const;
+
+public:
+    /*
+     * The matcher for the file types in a set of domains, created once.
+     */
+    static std::shared_ptr<FileTypeMatcher const>
+    Shared(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains);
+};
 
-    /* Reverse first so more specific file types are processed first. */
-    std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes = specManager->fileTypes(domains);
-    ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>> result = SortedFileTypes(fileTypes);
-    if (!result) {
-        fprintf(stderr, "error: cycle creating file type graph\n");
-        return nullptr;
+}
+
+FileTypeMatcher::
+FileTypeMatcher(std::vector<pbxspec::PBX::FileType::shared_ptr> const &fileTypes) :
+    _valid       (false),
+    _prefixes    ({ PrefixNode() }),
+    _headerLength(0)
+{
+    ext::optional<std::vector<pbxspec::PBX::FileType::shared_ptr>> sorted = SortedFileTypes(fileTypes);
+    if (!sorted) {
+        return;
     }
 
-    std::vector<pbxspec::PBX::FileType::shared_ptr> const &sortedFileTypes = *result;
-    for (pbxspec::PBX::FileType::shared_ptr const &fileType : sortedFileTypes) {
-        if (isReadable && fileType->isFolder() != isFolder) {
-            continue;
-        }
+    _valid = true;
+    _fileTypes = std::move(*sorted);
 
-        bool empty = true;
+    /*
+     * Index each type by its most selective check. A type with extensions
+     * only matches those extensions; otherwise, one with prefixes only
+     * matches those prefixes, and so on. Types with none of those checks
+     * are always candidates.
+     */
+    for (size_t n = 0; n < _fileTypes.size(); ++n) {
+        pbxspec::PBX::FileType::shared_ptr const &fileType = _fileTypes[n];
 
-        if (fileType->extensions()) {
-            empty = false;
-            bool matched = false;
+        if (fileType->magicWords()) {
+            for (std::vector<uint8_t> const &magicWord : *fileType->magicWords()) {
+                _headerLength = std::max(_headerLength, magicWord.size());
+            }
+        }
 
+        if (fileType->extensions()) {
+            /* Extensions compare case insensitively. */
             for (std::string const &extension : *fileType->extensions()) {
-                // TODO(grp): Is this correct? Needed for handling ".S" as ".s", but might be over-broad.
-                if (libutil::strcasecmp(extension.c_str(), fileExtension.c_str()) == 0) {
-                    matched = true;
-                }
+                _extensions[LowercaseString(extension)].push_back(n);
             }
-
-            if (!matched) {
-                continue;
+        } else if (fileType->prefix()) {
+            for (std::string const &prefix : *fileType->prefix()) {
+                size_t node = 0;
+                for (char c : prefix) {
+                    auto it = _prefixes[node].children.find(c);
+                    if (it != _prefixes[node].children.end()) {
+                        node = it->second;
+                    } else {
+                        _prefixes[node].children.insert({ c, _prefixes.size() });
+                        node = _prefixes.size();
+                        _prefixes.push_back(PrefixNode());
+                    }
+                }
+                _prefixes[node].fileTypes.push_back(n);
             }
+        } else if (fileType->filenamePatterns()) {
+            _patterns.push_back(n);
+        } else {
+            _remaining.push_back(n);
         }
+    }
+}
 
+std::vector<size_t> FileTypeMatcher::
+candidates(std::string const &fileName, std::string const &fileExtension) const
+{
+    std::vector<size_t> result = _remaining;
 
-        if (fileType->prefix()) {
-            empty = false;
-            bool matched = false;
+    auto it = _extensions.find(LowercaseString(fileExtension));
+    if (it != _extensions.end()) {
+        result.insert(result.end(), it->second.begin(), it->second.end());
+    }
 
-            for (std::string const &prefix : *fileType->prefix()) {
-                if (fileName.find(prefix) == 0) {
-                    matched = true;
-                }
-            }
+    size_t node = 0;
+    for (size_t n = 0; ; ++n) {
+        result.insert(result.end(), _prefixes[node].fileTypes.begin(), _prefixes[node].fileTypes.end());
 
-            if (!matched) {
-                continue;
+        if (n == fileName.size()) {
+            break;
+        }
+
+        auto child = _prefixes[node].children.find(fileName[n]);
+        if (child == _prefixes[node].children.end()) {
+            break;
+        }
+        node = child->second;
+    }
+
+    for (size_t index : _patterns) {
+        for (std::string const &pattern : *_fileTypes[index]->filenamePatterns()) {
+            if (Wildcard::Match(pattern, fileName)) {
+                result.push_back(index);
+                break;
             }
         }
+    }
 
-        if (fileType->filenamePatterns()) {
-            empty = false;
-            bool matched = false;
+    /* Keep the sorted order, so more specific types are checked first. */
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
 
-            for (std::string const &pattern : *fileType->filenamePatterns()) {
-                if (Wildcard::Match(pattern, fileName)) {
-                    matched = true;
-                }
+std::shared_ptr<FileTypeMatcher const> FileTypeMatcher::
+Shared(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains)
+{
+    /*
+     * Matchers are kept for each manager and domain set. Specifications are
+     * all registered before any file types are resolved.
+     */
+    struct Entry {
+        std::weak_ptr<pbxspec::Manager>        manager;
+        std::vector<std::string>               domains;
+        std::shared_ptr<FileTypeMatcher const> matcher;
+    };
+
+    static std::mutex *mutex = new std::mutex();
+    static std::vector<Entry> *entries = new std::vector<Entry>();
+
+    {
+        std::lock_guard<std::mutex> lock(*mutex);
+        for (Entry const &entry : *entries) {
+            if (entry.domains == domains && entry.manager.lock() == specManager) {
+                return entry.matcher;
             }
+        }
+    }
+
+    auto matcher = std::make_shared<FileTypeMatcher const>(specManager->fileTypes(domains));
+
+    std::lock_guard<std::mutex> lock(*mutex);
+    entries->erase(std::remove_if(entries->begin(), entries->end(), [](Entry const &entry) {
+        return entry.manager.expired();
+    }), entries->end());
+    entries->push_back({ specManager, domains, matcher });
+    return matcher;
+}
+
+static std::vector<uint8_t>
+ReadHeader(Filesystem const *filesystem, std::string const &filePath, size_t length)
+{
+    std::vector<uint8_t> header;
+
+    /* Reading past the end fails, so only read what is there. */
+    uint64_t size = 0;
+    uint64_t modified = 0;
+    if (length > 0 && filesystem->readFileInfo(filePath, &size, &modified)) {
+        length = std::min<uint64_t>(length, size);
+        if (!filesystem->read(&header, filePath, 0, length)) {
+            header.clear();
+        }
+    }
+
+    return header;
+}
+
+static bool
+MatchFileType(
+    Filesystem const *filesystem,
+    pbxspec::PBX::FileType::shared_ptr const &fileType,
+    std::string const &filePath,
+    std::string const &fileName,
+    std::string const &fileExtension,
+    size_t headerLength,
+    FileTypeResolver::Sniff *sniff)
+{
+    bool isReadable = sniff->readable();
+    bool isFolder = sniff->folder();
+
+    if (isReadable && fileType->isFolder() != isFolder) {
+        return false;
+    }
 
-            if (!matched) {
-                continue;
+    bool empty = true;
+
+    if (fileType->extensions()) {
+        empty = false;
+        bool matched = false;
+
+        for (std::string const &extension : *fileType->extensions()) {
+            // TODO(grp): Is this correct? Needed for handling ".S" as ".s", but might be over-broad.
+            if (libutil::strcasecmp(extension.c_str(), fileExtension.c_str()) == 0) {
+                matched = true;
             }
         }
 
-        if (isReadable && fileType->permissions()) {
-            empty = false;
-            bool matched = false;
+        if (!matched) {
+            return false;
+        }
+    }
 
-            std::string const &permissions = *fileType->permissions();
-            if (permissions == "read") {
-                matched = isReadable;
-            } else if (permissions == "write") {
-                matched = filesystem->isWritable(filePath);
-            } else if (permissions == "executable") {
-                matched = filesystem->isExecutable(filePath);
-            } else {
-                fprintf(stderr, "warning: unhandled permission %s\n", permissions.c_str());
+    if (fileType->prefix()) {
+        empty = false;
+        bool matched = false;
+
+        for (std::string const &prefix : *fileType->prefix()) {
+            if (fileName.find(prefix) == 0) {
+                matched = true;
             }
+        }
+
+        if (!matched) {
+            return false;
+        }
+    }
 
-            if (!matched) {
-                continue;
+    if (fileType->filenamePatterns()) {
+        empty = false;
+        bool matched = false;
+
+        for (std::string const &pattern : *fileType->filenamePatterns()) {
+            if (Wildcard::Match(pattern, fileName)) {
+                matched = true;
             }
         }
 
-        // TODO(grp): Support TypeCodes. Not very important.
+        if (!matched) {
+            return false;
+        }
+    }
 
-        if (isReadable && fileType->magicWords()) {
-            empty = false;
-            bool matched = false;
+    if (isReadable && fileType->permissions()) {
+        empty = false;
+        bool matched = false;
+
+        std::string const &permissions = *fileType->permissions();
+        if (permissions == "read") {
+            matched = isReadable;
+        } else if (permissions == "write") {
+            matched = filesystem->isWritable(filePath);
+        } else if (permissions == "executable") {
+            matched = filesystem->isExecutable(filePath);
+        } else {
+            fprintf(stderr, "warning: unhandled permission %s\n", permissions.c_str());
+        }
 
-            for (std::vector<uint8_t> const &magicWord : *fileType->magicWords()) {
-                if (fileContents.size() < magicWord.size()) {
-                    std::vector<uint8_t> next;
-                    if (!filesystem->read(&next, fileName, fileContents.size(), magicWord.size() - fileContents.size())) {
-                        continue;
-                    }
+        if (!matched) {
+            return false;
+        }
+    }
 
-                    fileContents.insert(fileContents.end(), next.begin(), next.end());
-                }
+    // TODO(grp): Support TypeCodes. Not very important.
 
-                assert(fileContents.size() == magicWord.size());
-                if (std::equal(magicWord.begin(), magicWord.end(), fileContents.begin())) {
-                    matched = true;
-                }
-            }
+    if (isReadable && fileType->magicWords()) {
+        empty = false;
+        bool matched = false;
+
+        /* Read once, for all file types. */
+        if (!sniff->header()) {
+            *sniff = FileTypeResolver::Sniff(isReadable, isFolder, ReadHeader(filesystem, filePath, headerLength));
+        }
 
-            if (!matched) {
-                continue;
+        std::vector<uint8_t> const &header = *sniff->header();
+        for (std::vector<uint8_t> const &magicWord : *fileType->magicWords()) {
+            if (header.size() >= magicWord.size() && std::equal(magicWord.begin(), magicWord.end(), header.begin())) {
+                matched = true;
             }
         }
 
-        /*
-         * Matched no checks.
-         */
-        if (empty) {
-            continue;
+        if (!matched) {
+            return false;
         }
+    }
 
-        /*
-         * Matched all checks.
-         */
-        return fileType;
+    /*
+     * Matched all checks, if there were any.
+     */
+    return !empty;
+}
+
+FileTypeResolver::Sniff::
+Sniff(bool readable, bool folder, ext::optional<std::vector<uint8_t>> const &header) :
+    _readable(readable),
+    _folder  (folder),
+    _header  (header)
+{
+}
+
+static FileTypeResolver::Sniff
+SniffPath(Filesystem const *filesystem, std::string const &filePath)
+{
+    bool isReadable = filesystem->isReadable(filePath);
+    bool isFolder = isReadable && filesystem->type(filePath) == Filesystem::Type::Directory;
+
+    /* Folders have no contents to check magic words against. */
+    if (!isReadable || isFolder) {
+        return FileTypeResolver::Sniff(isReadable, isFolder, std::vector<uint8_t>());
+    } else {
+        return FileTypeResolver::Sniff(isReadable, isFolder, ext::nullopt);
     }
+}
 
-    pbxspec::PBX::FileType::shared_ptr fileType = (isFolder ? specManager->fileType("folder", domains) : specManager->fileType("file", domains));
-    return fileType;
+FileTypeResolver::Sniff FileTypeResolver::Sniff::
+Read(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath)
+{
+    Sniff sniff = SniffPath(filesystem, filePath);
+
+    if (!sniff.header()) {
+        std::shared_ptr<FileTypeMatcher const> matcher = FileTypeMatcher::Shared(specManager, domains);
+        sniff._header = ReadHeader(filesystem, filePath, matcher->headerLength());
+    }
+
+    return sniff;
+}
+
+std::vector<FileTypeResolver::Sniff> FileTypeResolver::Sniff::
+Read(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::vector<std::string> const &filePaths)
+{
+    std::vector<Sniff> sniffs = std::vector<Sniff>(filePaths.size(), Sniff(false, false, ext::nullopt));
+    libutil::Parallel::For(filePaths.size(), [&](size_t n) {
+        sniffs[n] = Read(filesystem, specManager, domains, filePaths[n]);
+    });
+    return sniffs;
 }
 
 pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
-Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath)
+Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, std::string const &filePath, Sniff const *sniff)
+{
+    std::string fileExtension = FSUtil::GetFileExtension(filePath);
+    std::string fileName = FSUtil::GetBaseName(filePath);
+
+    std::shared_ptr<FileTypeMatcher const> matcher = FileTypeMatcher::Shared(specManager, domains);
+    if (!matcher->valid()) {
+        fprintf(stderr, "error: cycle creating file type graph\n");
+        return nullptr;
+    }
+
+    /* Without a sniff, the header is read only if a magic word is checked. */
+    Sniff current = (sniff != nullptr ? *sniff : SniffPath(filesystem, filePath));
+
+    for (size_t index : matcher->candidates(fileName, fileExtension)) {
+        pbxspec::PBX::FileType::shared_ptr const &fileType = matcher->fileTypes()[index];
+        if (MatchFileType(filesystem, fileType, filePath, fileName, fileExtension, matcher->headerLength(), &current)) {
+            return fileType;
+        }
+    }
+
+    pbxspec::PBX::FileType::shared_ptr fileType = (current.folder() ? specManager->fileType("folder", domains) : specManager->fileType("file", domains));
+    return fileType;
+}
+
+static pbxspec::PBX::FileType::shared_ptr
+ReferenceFileType(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference)
 {
     if (!fileReference->explicitFileType().empty()) {
         if (pbxspec::PBX::FileType::shared_ptr const &fileType = specManager->fileType(fileReference->explicitFileType(), domains)) {
@@ -191,11 +461,21 @@ Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specMa
         }
     }
 
-    return Resolve(filesystem, specManager, domains, filePath);
+    return nullptr;
 }
 
 pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
-Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath)
+Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath, Sniff const *sniff)
+{
+    if (pbxspec::PBX::FileType::shared_ptr fileType = ReferenceFileType(specManager, domains, fileReference)) {
+        return fileType;
+    }
+
+    return Resolve(filesystem, specManager, domains, filePath, sniff);
+}
+
+pbxspec::PBX::FileType::shared_ptr FileTypeResolver::
+Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::XC::VersionGroup::shared_ptr const &versionGroup, std::string const &filePath, Sniff const *sniff)
 {
     if (!versionGroup->versionGroupType().empty()) {
         if (pbxspec::PBX::FileType::shared_ptr const &fileType = specManager->fileType(versionGroup->versionGroupType(), domains)) {
@@ -203,5 +483,11 @@ Resolve(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specMa
         }
     }
 
-    return Resolve(filesystem, specManager, domains, filePath);
+    return Resolve(filesystem, specManager, domains, filePath, sniff);
+}
+
+bool FileTypeResolver::
+NeedsSniff(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &domains, pbxproj::PBX::FileReference::shared_ptr const &fileReference)
+{
+    return ReferenceFileType(specManager, domains, fileReference) == nullptr;
 }
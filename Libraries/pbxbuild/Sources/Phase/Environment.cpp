@@ -30,19 +30,12 @@ Phase::Environment::
 pbxsetting::Level Phase::Environment::
 VariantLevel(std::string const &variant)
 {
-    return pbxsetting::Level({
-        pbxsetting::Setting::Create("CURRENT_VARIANT", variant),
-        pbxsetting::Setting::Create("variant", variant),
-        pbxsetting::Setting::Create("EXECUTABLE_VARIANT_SUFFIX", variant != "normal" ? "_" + variant : ""),
-    });
+    return Target::Environment::VariantLevel(variant);
 }
 
 pbxsetting::Level Phase::Environment::
 ArchitectureLevel(std::string const &arch)
 {
-    return pbxsetting::Level({
-        pbxsetting::Setting::Create("CURRENT_ARCH", arch),
-        pbxsetting::Setting::Create("arch", arch),
-    });
+    return Target::Environment::ArchitectureLevel(arch);
 }
 
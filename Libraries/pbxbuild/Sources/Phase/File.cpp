@@ -22,6 +22,23 @@ namespace Build = pbxbuild::Build;
 using pbxbuild::FileTypeResolver;
 using libutil::Filesystem;
 
+namespace {
+
+/*
+ * A build file input, before its file type is determined.
+ */
+struct PendingInput {
+    pbxproj::PBX::BuildFile::shared_ptr     buildFile;
+    pbxproj::PBX::FileReference::shared_ptr fileReference;
+    pbxproj::XC::VersionGroup::shared_ptr   versionGroup;
+    std::string                             path;
+    ext::optional<std::string>              fileNameDisambiguator;
+    ext::optional<std::string>              localization;
+    ext::optional<std::string>              localizationGroupIdentifier;
+};
+
+}
+
 std::vector<Tool::Input> Phase::File::
 ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseEnvironment, pbxsetting::Environment const &environment, std::vector<pbxproj::PBX::BuildFile::shared_ptr> const &buildFiles)
 {
@@ -30,7 +47,8 @@ ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseE
     Build::Environment const &buildEnvironment = phaseEnvironment.buildEnvironment();
     Build::Context const &buildContext = phaseEnvironment.buildContext();
 
-    std::vector<Tool::Input> result;
+    std::vector<std::string> const domains = { pbxspec::Manager::AnyDomain() };
+    std::vector<PendingInput> pending;
 
     for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildFiles) {
         if (buildFile->fileRef() == nullptr) {
@@ -49,11 +67,7 @@ ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseE
                 pbxproj::PBX::FileReference::shared_ptr const &fileReference = std::static_pointer_cast <pbxproj::PBX::FileReference> (buildFile->fileRef());
 
                 std::string path = environment.expand(fileReference->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(filesystem, buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, fileReference, path);
-
-                Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
-                Tool::Input file = Tool::Input(path, fileType, buildRule, fileNameDisambiguator, ext::nullopt, ext::nullopt, buildFile->attributes(), buildFile->compilerFlags());
-                result.push_back(file);
+                pending.push_back({ buildFile, fileReference, nullptr, path, fileNameDisambiguator, ext::nullopt, ext::nullopt });
                 break;
             }
             case pbxproj::PBX::GroupItem::Type::ReferenceProxy: {
@@ -77,11 +91,7 @@ ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseE
 
                 pbxproj::PBX::FileReference::shared_ptr const &fileReference = remote->second;
                 std::string path = remoteEnvironment->environment().expand(fileReference->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(filesystem, buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, fileReference, path);
-
-                Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
-                Tool::Input file = Tool::Input(path, fileType, buildRule, ext::nullopt, ext::nullopt, ext::nullopt, buildFile->attributes(), buildFile->compilerFlags());
-                result.push_back(file);
+                pending.push_back({ buildFile, fileReference, nullptr, path, ext::nullopt, ext::nullopt, ext::nullopt });
                 break;
             }
             case pbxproj::PBX::GroupItem::Type::VariantGroup: {
@@ -95,11 +105,7 @@ ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseE
                     std::string const &localization = fileReference->name();
 
                     std::string path = environment.expand(fileReference->resolve());
-                    pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(filesystem, buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, fileReference, path);
-
-                    Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
-                    Tool::Input file = Tool::Input(path, fileType, buildRule, fileNameDisambiguator, localization, buildFile->blueprintIdentifier(), buildFile->attributes(), buildFile->compilerFlags());
-                    result.push_back(file);
+                    pending.push_back({ buildFile, fileReference, nullptr, path, fileNameDisambiguator, localization, buildFile->blueprintIdentifier() });
                 }
                 break;
             }
@@ -107,11 +113,7 @@ ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseE
                 pbxproj::XC::VersionGroup::shared_ptr const &versionGroup = std::static_pointer_cast <pbxproj::XC::VersionGroup> (buildFile->fileRef());
 
                 std::string path = environment.expand(versionGroup->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(filesystem, buildEnvironment.specManager(), { pbxspec::Manager::AnyDomain() }, versionGroup, path);
-
-                Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, path);
-                Tool::Input file = Tool::Input(path, fileType, buildRule, fileNameDisambiguator, ext::nullopt, ext::nullopt, buildFile->attributes(), buildFile->compilerFlags());
-                result.push_back(file);
+                pending.push_back({ buildFile, nullptr, versionGroup, path, fileNameDisambiguator, ext::nullopt, ext::nullopt });
                 break;
 
             }
@@ -122,5 +124,42 @@ ResolveBuildFiles(Filesystem const *filesystem, Phase::Environment const &phaseE
         }
     }
 
+    /*
+     * Read the files whose types depend on their contents all at once, rather
+     * than one at a time while resolving file types.
+     */
+    std::vector<size_t> sniffIndexes;
+    std::vector<std::string> sniffPaths;
+    for (size_t n = 0; n < pending.size(); ++n) {
+        if (pending[n].fileReference != nullptr && FileTypeResolver::NeedsSniff(buildEnvironment.specManager(), domains, pending[n].fileReference)) {
+            sniffIndexes.push_back(n);
+            sniffPaths.push_back(pending[n].path);
+        }
+    }
+
+    std::vector<FileTypeResolver::Sniff> sniffs = FileTypeResolver::Sniff::Read(filesystem, buildEnvironment.specManager(), domains, sniffPaths);
+    std::vector<FileTypeResolver::Sniff const *> pendingSniffs = std::vector<FileTypeResolver::Sniff const *>(pending.size(), nullptr);
+    for (size_t n = 0; n < sniffIndexes.size(); ++n) {
+        pendingSniffs[sniffIndexes[n]] = &sniffs[n];
+    }
+
+    std::vector<Tool::Input> result;
+    result.reserve(pending.size());
+
+    for (size_t n = 0; n < pending.size(); ++n) {
+        PendingInput const &input = pending[n];
+
+        pbxspec::PBX::FileType::shared_ptr fileType;
+        if (input.fileReference != nullptr) {
+            fileType = FileTypeResolver::Resolve(filesystem, buildEnvironment.specManager(), domains, input.fileReference, input.path, pendingSniffs[n]);
+        } else {
+            fileType = FileTypeResolver::Resolve(filesystem, buildEnvironment.specManager(), domains, input.versionGroup, input.path, pendingSniffs[n]);
+        }
+
+        Target::BuildRules::BuildRule::shared_ptr buildRule = buildRules.resolve(fileType, input.path);
+        Tool::Input file = Tool::Input(input.path, fileType, buildRule, input.fileNameDisambiguator, input.localization, input.localizationGroupIdentifier, input.buildFile->attributes(), input.buildFile->compilerFlags());
+        result.push_back(file);
+    }
+
     return result;
 }
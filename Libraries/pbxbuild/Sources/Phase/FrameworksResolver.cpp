@@ -88,8 +88,7 @@ resolve(Phase::Environment const &phaseEnvironment, Phase::Context *phaseContext
         std::vector<Tool::Input> universalBinaryInputs;
 
         for (std::string const &arch : targetEnvironment.architectures()) {
-            pbxsetting::Environment archEnvironment = pbxsetting::Environment(variantEnvironment);
-            archEnvironment.insertFront(Phase::Environment::ArchitectureLevel(arch), false);
+            pbxsetting::Environment const &archEnvironment = targetEnvironment.variantArchitectureEnvironment(variant, arch);
 
             std::vector<Tool::Input> sourceOutputs;
             auto it = phaseContext->toolContext().variantArchitectureInvocations().find(std::make_pair(variant, arch));
@@ -160,9 +160,7 @@ resolve(Phase::Environment const &phaseEnvironment, Phase::Context *phaseContext
     std::vector<std::vector<Tool::Input>> architectureGroups = Phase::Context::Group(architectureFiles);
     for (std::string const &variant : targetEnvironment.variants()) {
         for (std::string const &arch : targetEnvironment.architectures()) {
-            pbxsetting::Environment currentEnvironment = pbxsetting::Environment(targetEnvironment.environment());
-            currentEnvironment.insertFront(Phase::Environment::VariantLevel(variant), false);
-            currentEnvironment.insertFront(Phase::Environment::ArchitectureLevel(arch), false);
+            pbxsetting::Environment const &currentEnvironment = targetEnvironment.variantArchitectureEnvironment(variant, arch);
 
             std::string outputDirectory = currentEnvironment.expand(pbxsetting::Value::Parse("$(OBJECT_FILE_DIR_$(variant))/$(arch)"));
 
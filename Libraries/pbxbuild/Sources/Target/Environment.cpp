@@ -54,10 +54,56 @@ Environment(
     _variants                (variants),
     _architectures           (architectures),
     _workingDirectory        (workingDirectory),
-    _buildFileDisambiguation (buildFileDisambiguation)
+    _buildFileDisambiguation (buildFileDisambiguation),
+    _variantArchitectureEnvironments(std::make_shared<VariantArchitectureEnvironments>())
 {
 }
 
+pbxsetting::Environment const &Target::Environment::
+variantArchitectureEnvironment(std::string const &variant, std::string const &arch) const
+{
+    std::lock_guard<std::mutex> lock(_variantArchitectureEnvironments->mutex);
+
+    auto key = std::make_pair(variant, arch);
+    auto it = _variantArchitectureEnvironments->environments.find(key);
+    if (it != _variantArchitectureEnvironments->environments.end()) {
+        return it->second;
+    }
+
+    std::unordered_map<std::string, std::string> values = {
+        { "variant", variant },
+        { "arch", arch },
+    };
+    if (_sdk->canonicalName()) {
+        values.insert({ "sdk", *_sdk->canonicalName() });
+    }
+
+    pbxsetting::Environment environment = _environment.specialize(pbxsetting::Condition(values));
+    environment.insertFront(VariantLevel(variant), false);
+    environment.insertFront(ArchitectureLevel(arch), false);
+
+    return _variantArchitectureEnvironments->environments.insert(std::make_pair(key, std::move(environment))).first->second;
+}
+
+pbxsetting::Level Target::Environment::
+VariantLevel(std::string const &variant)
+{
+    return pbxsetting::Level({
+        pbxsetting::Setting::Create("CURRENT_VARIANT", variant),
+        pbxsetting::Setting::Create("variant", variant),
+        pbxsetting::Setting::Create("EXECUTABLE_VARIANT_SUFFIX", variant != "normal" ? "_" + variant : ""),
+    });
+}
+
+pbxsetting::Level Target::Environment::
+ArchitectureLevel(std::string const &arch)
+{
+    return pbxsetting::Level({
+        pbxsetting::Setting::Create("CURRENT_ARCH", arch),
+        pbxsetting::Setting::Create("arch", arch),
+    });
+}
+
 static std::unordered_map<pbxproj::PBX::BuildFile::shared_ptr, std::string>
 BuildFileDisambiguation(pbxproj::PBX::Target::shared_ptr const &target)
 {
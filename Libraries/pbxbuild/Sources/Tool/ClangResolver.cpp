@@ -195,6 +195,77 @@ resolvePrecompiledHeader(
     toolContext->auxiliaryFiles().push_back(serializedFile);
 }
 
+std::shared_ptr<Tool::ClangResolver::SourcePrefix> Tool::ClangResolver::
+sourcePrefix(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    Tool::Input const &input,
+    std::string const &output) const
+{
+    ext::optional<std::string> const &dialect = (input.fileType() != nullptr ? input.fileType()->GCCDialectName() : ext::nullopt);
+
+    /*
+     * Options and flag settings don't depend on the input file, only on the variant,
+     * architecture, and file type. A custom command line could reference the input,
+     * so only share the prefix when the compiler uses the default command line.
+     */
+    bool shared = !_compiler->commandLine();
+    SourcePrefixKey key = SourcePrefixKey(
+        environment.resolve("variant"),
+        environment.resolve("arch"),
+        (input.fileType() != nullptr ? input.fileType()->identifier() : ""));
+
+    if (shared) {
+        std::lock_guard<std::mutex> lock(_sourcePrefixesMutex);
+
+        auto it = _sourcePrefixes.find(key);
+        if (it != _sourcePrefixes.end()) {
+            return it->second;
+        }
+    }
+
+    pbxspec::PBX::Tool::shared_ptr tool = std::static_pointer_cast <pbxspec::PBX::Tool> (_compiler);
+    Tool::Environment toolEnvironment = (shared ?
+        Tool::Environment::Create(tool, environment, toolContext->workingDirectory(), { }) :
+        Tool::Environment::Create(tool, environment, toolContext->workingDirectory(), { input }, { output }));
+    pbxsetting::Environment const &env = toolEnvironment.environment();
+
+    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), input.fileType());
+    Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
+
+    auto prefix = std::make_shared<SourcePrefix>();
+    prefix->executable = tokens.executable();
+    prefix->environment = options.environment();
+    prefix->linkerArgs = options.linkerArgs();
+
+    std::vector<std::string> arguments;
+    AppendDialectFlags(&arguments, dialect);
+    prefix->dialectOffset = arguments.size();
+
+    arguments.insert(arguments.end(), tokens.arguments().begin(), tokens.arguments().end());
+    Tool::CompilerCommon::AppendIncludePathFlags(&arguments, env, toolContext->searchPaths(), toolContext->headermapInfo());
+    AppendFrameworkPathFlags(&arguments, env, toolContext->searchPaths());
+    AppendCustomFlags(&arguments, env, dialect);
+
+    /* Interned once here, so every source using this prefix shares the arguments. */
+    prefix->arguments = std::move(arguments);
+
+    std::string prefixHeader = env.resolve("GCC_PREFIX_HEADER");
+    if (!prefixHeader.empty()) {
+        prefix->prefixHeaderFile = FSUtil::ResolveRelativePath(prefixHeader, toolContext->workingDirectory());
+    }
+    prefix->precompilePrefixHeader = pbxsetting::Type::ParseBoolean(env.resolve("GCC_PRECOMPILE_PREFIX_HEADER"));
+
+    AppendNotUsedInPrecompsFlags(&prefix->notUsedInPrecompsArguments, env);
+
+    if (shared) {
+        /* Not locked while creating. If the same prefix was created twice at once, the first one is kept. */
+        std::lock_guard<std::mutex> lock(_sourcePrefixesMutex);
+        return _sourcePrefixes.insert({ key, prefix }).first->second;
+    }
+    return prefix;
+}
+
 void Tool::ClangResolver::
 resolveSource(
     Tool::Context *toolContext,
@@ -222,50 +293,55 @@ resolveSource(
     ext::optional<std::string> const &dialect = (input.fileType() != nullptr ? input.fileType()->GCCDialectName() : ext::nullopt);
     std::vector<std::string> inputArguments = input.compilerFlags().value_or(std::vector<std::string>());
 
+    std::shared_ptr<SourcePrefix> prefix = sourcePrefix(toolContext, environment, input, output);
+
     pbxspec::PBX::Tool::shared_ptr tool = std::static_pointer_cast <pbxspec::PBX::Tool> (_compiler);
     Tool::Environment toolEnvironment = Tool::Environment::Create(tool, environment, toolContext->workingDirectory(), { input }, { output });
     pbxsetting::Environment const &env = toolEnvironment.environment();
 
-    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), input.fileType());
-    Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
-
     std::vector<std::string> inputDependencies;
     inputDependencies.insert(inputDependencies.end(), headermapInfo.systemHeadermapFiles().begin(), headermapInfo.systemHeadermapFiles().end());
     inputDependencies.insert(inputDependencies.end(), headermapInfo.userHeadermapFiles().begin(), headermapInfo.userHeadermapFiles().end());
 
+    /* Only the arguments specific to this source; the prefix arguments are shared. */
     std::vector<std::string> arguments;
-    AppendDialectFlags(&arguments, dialect);
-    size_t dialectOffset = arguments.size();
-
-    arguments.insert(arguments.end(), tokens.arguments().begin(), tokens.arguments().end());
-    Tool::CompilerCommon::AppendIncludePathFlags(&arguments, env, toolContext->searchPaths(), headermapInfo);
-    AppendFrameworkPathFlags(&arguments, env, toolContext->searchPaths());
-    AppendCustomFlags(&arguments, env, dialect);
-
-    bool precompilePrefixHeader = pbxsetting::Type::ParseBoolean(env.resolve("GCC_PRECOMPILE_PREFIX_HEADER"));
-    std::string prefixHeader = env.resolve("GCC_PREFIX_HEADER");
     std::shared_ptr<Tool::PrecompiledHeaderInfo> precompiledHeaderInfo = nullptr;
 
-    if (!prefixHeader.empty()) {
-        std::string prefixHeaderFile = FSUtil::ResolveRelativePath(prefixHeader, toolContext->workingDirectory());
-
-        if (precompilePrefixHeader) {
-            std::vector<std::string> precompiledHeaderArguments;
-            AppendDialectFlags(&precompiledHeaderArguments, dialect, "-header");
-            precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), arguments.begin() + dialectOffset, arguments.end());
-            // Added below, but need to have here in case it affects the precompiled header (as it often does).
-            precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), inputArguments.begin(), inputArguments.end());
+    if (!prefix->prefixHeaderFile.empty()) {
+        if (prefix->precompilePrefixHeader) {
+            /* Files without their own compiler flags all share the same precompiled header. */
+            if (inputArguments.empty()) {
+                std::lock_guard<std::mutex> lock(_sourcePrefixesMutex);
+                precompiledHeaderInfo = prefix->precompiledHeaderInfo;
+            }
+
+            if (precompiledHeaderInfo == nullptr) {
+                std::vector<std::string> precompiledHeaderArguments;
+                AppendDialectFlags(&precompiledHeaderArguments, dialect, "-header");
+                precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), prefix->arguments.begin() + prefix->dialectOffset, prefix->arguments.end());
+                // Added below, but need to have here in case it affects the precompiled header (as it often does).
+                precompiledHeaderArguments.insert(precompiledHeaderArguments.end(), inputArguments.begin(), inputArguments.end());
+
+                precompiledHeaderInfo = std::make_shared<Tool::PrecompiledHeaderInfo>(PrecompiledHeaderInfo::Create(_compiler, prefix->prefixHeaderFile, input.fileType(), precompiledHeaderArguments));
+                if (inputArguments.empty()) {
+                    std::lock_guard<std::mutex> lock(_sourcePrefixesMutex);
+                    if (prefix->precompiledHeaderInfo == nullptr) {
+                        prefix->precompiledHeaderInfo = precompiledHeaderInfo;
+                    } else {
+                        precompiledHeaderInfo = prefix->precompiledHeaderInfo;
+                    }
+                }
+            }
 
-            precompiledHeaderInfo = std::make_shared<Tool::PrecompiledHeaderInfo>(PrecompiledHeaderInfo::Create(_compiler, prefixHeaderFile, input.fileType(), precompiledHeaderArguments));
             AppendPrefixHeaderFlags(&arguments, env.expand(precompiledHeaderInfo->logicalOutputPath()));
             inputDependencies.push_back(env.expand(precompiledHeaderInfo->compileOutputPath()));
         } else {
-            AppendPrefixHeaderFlags(&arguments, prefixHeaderFile);
-            inputDependencies.push_back(prefixHeaderFile);
+            AppendPrefixHeaderFlags(&arguments, prefix->prefixHeaderFile);
+            inputDependencies.push_back(prefix->prefixHeaderFile);
         }
     }
 
-    AppendNotUsedInPrecompsFlags(&arguments, env);
+    arguments.insert(arguments.end(), prefix->notUsedInPrecompsArguments.begin(), prefix->notUsedInPrecompsArguments.end());
     // After all of the configurable settings, so they can override.
     arguments.insert(arguments.end(), inputArguments.begin(), inputArguments.end());
     AppendDependencyInfoFlags(&arguments, _compiler, env);
@@ -281,9 +357,9 @@ resolveSource(
     }
 
     Tool::Invocation invocation;
-    invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
-    invocation.arguments() = arguments;
-    invocation.environment() = options.environment();
+    invocation.executable() = Tool::Invocation::Executable::Determine(prefix->executable);
+    invocation.arguments() = Tool::Invocation::Arguments(prefix->arguments, arguments);
+    invocation.environment() = prefix->environment;
     invocation.workingDirectory() = toolContext->workingDirectory();
     invocation.inputs() = toolEnvironment.inputs(toolContext->workingDirectory());
     invocation.outputs() = toolEnvironment.outputs(toolContext->workingDirectory());
@@ -326,7 +402,7 @@ resolveSource(
         compilationInfo->linkerDriver() = _compiler->execPath()->raw();
     }
 
-    for (std::string const &linkerArg : options.linkerArgs()) {
+    for (std::string const &linkerArg : prefix->linkerArgs) {
         std::vector<std::string> *linkerArguments = &compilationInfo->linkerArguments();
 
         /* Avoid duplicating arguments for multiple compiler invocations. */
@@ -0,0 +1,218 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxbuild/Tool/CompiledOptions.h>
+#include <plist/Array.h>
+#include <plist/Dictionary.h>
+#include <plist/Object.h>
+#include <plist/String.h>
+
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+namespace Tool = pbxbuild::Tool;
+
+static std::vector<pbxsetting::Value>
+ArgumentValuesFromArray(plist::Array const *args)
+{
+    std::vector<pbxsetting::Value> values;
+    for (size_t n = 0; n < args->count(); n++) {
+        if (auto arg = args->value <plist::String> (n)) {
+            values.push_back(pbxsetting::Value::Parse(arg->value()));
+        }
+    }
+    return values;
+}
+
+Tool::CompiledOptions::Arguments::
+Arguments()
+{
+}
+
+Tool::CompiledOptions::Arguments::
+Arguments(plist::Object const *arguments)
+{
+    /*
+     * `CommandLineArgs` and `AdditionalLinkerArgs` are either arrays of arguments or dictionaries
+     * mapping values to arrays of arguments. The key `<<otherwise>>` is special-cased as a fallback.
+     */
+
+    if (auto args = plist::CastTo <plist::Array> (arguments)) {
+        _always = ArgumentValuesFromArray(args);
+    } else if (auto argsValues = plist::CastTo <plist::Dictionary> (arguments)) {
+        for (size_t n = 0; n < argsValues->count(); n++) {
+            std::string const &key = argsValues->key(n);
+            if (auto args = argsValues->value <plist::Array> (n)) {
+                if (key == "<<otherwise>>") {
+                    _otherwise = ArgumentValuesFromArray(args);
+                } else {
+                    _values.insert({ key, ArgumentValuesFromArray(args) });
+                }
+            }
+        }
+    }
+}
+
+std::vector<pbxsetting::Value> const *Tool::CompiledOptions::Arguments::
+find(std::string const &value) const
+{
+    if (_always) {
+        return &*_always;
+    }
+
+    auto it = _values.find(value);
+    if (it != _values.end()) {
+        return &it->second;
+    } else if (_otherwise) {
+        return &*_otherwise;
+    } else {
+        return nullptr;
+    }
+}
+
+static void
+AddValueArguments(std::unordered_map<std::string, Tool::CompiledOptions::Option::ValueArguments> *valueArguments, plist::Array const *values)
+{
+    if (values == nullptr) {
+        return;
+    }
+
+    /*
+     * `Values` and `AllowedValues` are arrays of value dictoinaries. Each value has a key `Value`
+     * with the expected value itself and `CommandLineFlag` / `CommandLineArguments` to add for it.
+     */
+
+    for (size_t n = 0; n < values->count(); n++) {
+        if (auto entry = values->value <plist::Dictionary> (n)) {
+            if (auto entryValue = entry->value <plist::String> ("Value")) {
+                if (auto entryFlag = entry->value <plist::String> ("CommandLineFlag")) {
+                    (*valueArguments)[entryValue->value()].push_back({ pbxsetting::Value::Parse(entryFlag->value()) });
+                } else if (auto entryArgs = entry->value <plist::Array> ("CommandLineArgs")) {
+                    (*valueArguments)[entryValue->value()].push_back(ArgumentValuesFromArray(entryArgs));
+                }
+            }
+        }
+    }
+}
+
+static ext::optional<Tool::Condition>
+ParseCondition(pbxspec::PBX::PropertyOption::shared_ptr const &option, std::string const &condition)
+{
+    ext::optional<Tool::Condition> result = Tool::Condition::Parse(condition);
+    if (!result) {
+        /* Invalid conditions are ignored, so the option always applies. */
+        fprintf(stderr, "warning: invalid condition '%s' for option %s\n", condition.c_str(), option->name().c_str());
+    }
+    return result;
+}
+
+Tool::CompiledOptions::Option::
+Option(pbxspec::PBX::PropertyOption::shared_ptr const &option) :
+    _option              (option),
+    _boolean             (option->type() == "Boolean" || option->type() == "bool"),
+    _list                ((option->type() == "StringList" || option->type() == "stringlist") ||
+                          (option->type() == "PathList" || option->type() == "pathlist")),
+    _commandLineArgs     (option->commandLineArgs()),
+    _additionalLinkerArgs(option->additionalLinkerArgs())
+{
+    if (option->condition()) {
+        _condition = ParseCondition(option, *option->condition());
+    }
+    if (option->commandLineCondition()) {
+        _commandLineCondition = ParseCondition(option, *option->commandLineCondition());
+    }
+
+    if (option->architectures()) {
+        _architectures = std::unordered_set<std::string>(option->architectures()->begin(), option->architectures()->end());
+    }
+    if (option->fileTypes()) {
+        _fileTypes = std::unordered_set<std::string>(option->fileTypes()->begin(), option->fileTypes()->end());
+    }
+
+    if (!_boolean && option->commandLineFlag()) {
+        /* Pass both the command line flag and the option value itself. */
+        _flagArguments = { *option->commandLineFlag(), pbxsetting::Value::Variable("value") };
+    }
+
+    if (option->commandLinePrefixFlag()) {
+        /* Pass the prefix then the option value in the same argument. */
+        _prefixArgument = *option->commandLinePrefixFlag() + pbxsetting::Value::Variable("value");
+    }
+
+    AddValueArguments(&_valueArguments, plist::CastTo<plist::Array>(option->values()));
+    AddValueArguments(&_valueArguments, plist::CastTo<plist::Array>(option->allowedValues()));
+}
+
+bool Tool::CompiledOptions::Option::
+matchesArchitecture(std::string const &architecture) const
+{
+    return !_architectures || _architectures->find(architecture) != _architectures->end();
+}
+
+bool Tool::CompiledOptions::Option::
+matchesFileType(pbxspec::PBX::FileType::shared_ptr const &fileType) const
+{
+    return !_fileTypes || fileType == nullptr || _fileTypes->find(fileType->identifier()) != _fileTypes->end();
+}
+
+Tool::CompiledOptions::Option::ValueArguments const *Tool::CompiledOptions::Option::
+valueArguments(std::string const &value) const
+{
+    auto it = _valueArguments.find(value);
+    if (it != _valueArguments.end()) {
+        return &it->second;
+    } else {
+        return nullptr;
+    }
+}
+
+Tool::CompiledOptions::
+CompiledOptions(
+    std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
+    std::unordered_set<std::string> const &deletedSettings)
+{
+    _options.reserve(options.size());
+    for (pbxspec::PBX::PropertyOption::shared_ptr const &option : options) {
+        if (deletedSettings.find(option->name()) != deletedSettings.end()) {
+            continue;
+        }
+
+        _options.push_back(Option(option));
+    }
+}
+
+Tool::CompiledOptions::shared_ptr Tool::CompiledOptions::
+Shared(pbxspec::PBX::Tool::shared_ptr const &tool)
+{
+    struct CachedOptions {
+        std::weak_ptr<pbxspec::PBX::Tool> tool;
+        CompiledOptions::shared_ptr       options;
+    };
+
+    /* Specifications are immutable once loaded, so compile each tool once. */
+    static std::mutex *mutex = new std::mutex();
+    static auto *cache = new std::unordered_map<pbxspec::PBX::Tool const *, CachedOptions>();
+
+    {
+        std::lock_guard<std::mutex> lock(*mutex);
+        auto it = cache->find(tool.get());
+        if (it != cache->end() && it->second.tool.lock() == tool) {
+            return it->second.options;
+        }
+    }
+
+    auto options = std::make_shared<CompiledOptions const>(
+        tool->options().value_or(pbxspec::PBX::PropertyOption::vector()),
+        tool->deletedProperties().value_or(std::unordered_set<std::string>()));
+
+    std::lock_guard<std::mutex> lock(*mutex);
+    (*cache)[tool.get()] = CachedOptions { tool, options };
+    return options;
+}
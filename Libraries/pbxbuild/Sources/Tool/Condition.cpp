@@ -0,0 +1,258 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxbuild/Tool/Condition.h>
+#include <pbxsetting/Environment.h>
+
+#include <cctype>
+#include <cstring>
+
+namespace Tool = pbxbuild::Tool;
+
+Tool::Condition::
+Condition(std::vector<Node> const &nodes, size_t root) :
+    _nodes(nodes),
+    _root (root)
+{
+}
+
+bool Tool::Condition::
+evaluate(pbxsetting::Environment const &environment) const
+{
+    return evaluate(environment, _root);
+}
+
+bool Tool::Condition::
+evaluate(pbxsetting::Environment const &environment, size_t index) const
+{
+    Node const &node = _nodes[index];
+
+    switch (node.op) {
+        case Operator::Value:
+            return environment.expand(node.value) != "NO";
+        case Operator::Equal:
+            return environment.expand(_nodes[node.lhs].value) == environment.expand(_nodes[node.rhs].value);
+        case Operator::NotEqual:
+            return environment.expand(_nodes[node.lhs].value) != environment.expand(_nodes[node.rhs].value);
+        case Operator::Not:
+            return !evaluate(environment, node.lhs);
+        case Operator::And:
+            return evaluate(environment, node.lhs) && evaluate(environment, node.rhs);
+        case Operator::Or:
+            return evaluate(environment, node.lhs) || evaluate(environment, node.rhs);
+    }
+
+    return false;
+}
+
+/*
+ * Recursive descent parser for condition expressions. Precedence from
+ * lowest to highest is `||`, `&&`, `!`, then comparisons.
+ */
+class Tool::Condition::Parser {
+private:
+    std::string const &_expression;
+    size_t             _offset;
+    std::vector<Node>  _nodes;
+
+public:
+    explicit Parser(std::string const &expression) :
+        _expression(expression),
+        _offset    (0)
+    {
+    }
+
+public:
+    std::vector<Node> const &nodes() const
+    { return _nodes; }
+
+public:
+    /*
+     * Parse the full expression, failing if anything is left over.
+     */
+    ext::optional<size_t> parse()
+    {
+        ext::optional<size_t> root = parseOr();
+        skipWhitespace();
+        if (!root || _offset != _expression.size()) {
+            return ext::nullopt;
+        }
+        return root;
+    }
+
+private:
+    size_t add(Operator op, size_t lhs, size_t rhs, pbxsetting::Value const &value = pbxsetting::Value::Empty())
+    {
+        _nodes.push_back(Node { op, lhs, rhs, value });
+        return _nodes.size() - 1;
+    }
+
+    void skipWhitespace()
+    {
+        while (_offset < _expression.size() && isspace(_expression[_offset])) {
+            _offset++;
+        }
+    }
+
+    bool consume(char const *token)
+    {
+        skipWhitespace();
+
+        size_t length = strlen(token);
+        if (_expression.compare(_offset, length, token) == 0) {
+            _offset += length;
+            return true;
+        }
+        return false;
+    }
+
+    bool atOperator() const
+    {
+        if (_offset >= _expression.size()) {
+            return true;
+        }
+
+        char c = _expression[_offset];
+        if (isspace(c) || c == '(' || c == ')') {
+            return true;
+        }
+
+        return _expression.compare(_offset, 2, "&&") == 0 ||
+               _expression.compare(_offset, 2, "||") == 0 ||
+               _expression.compare(_offset, 2, "==") == 0 ||
+               _expression.compare(_offset, 2, "!=") == 0;
+    }
+
+private:
+    ext::optional<size_t> parseOr()
+    {
+        ext::optional<size_t> lhs = parseAnd();
+        while (lhs && consume("||")) {
+            ext::optional<size_t> rhs = parseAnd();
+            if (!rhs) {
+                return ext::nullopt;
+            }
+            lhs = add(Operator::Or, *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    ext::optional<size_t> parseAnd()
+    {
+        ext::optional<size_t> lhs = parseUnary();
+        while (lhs && consume("&&")) {
+            ext::optional<size_t> rhs = parseUnary();
+            if (!rhs) {
+                return ext::nullopt;
+            }
+            lhs = add(Operator::And, *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    ext::optional<size_t> parseUnary()
+    {
+        skipWhitespace();
+        if (_expression.compare(_offset, 2, "!=") != 0 && consume("!")) {
+            ext::optional<size_t> operand = parseUnary();
+            if (!operand) {
+                return ext::nullopt;
+            }
+            return add(Operator::Not, *operand, 0);
+        }
+
+        return parseComparison();
+    }
+
+    ext::optional<size_t> parseComparison()
+    {
+        if (consume("(")) {
+            ext::optional<size_t> inner = parseOr();
+            if (!inner || !consume(")")) {
+                return ext::nullopt;
+            }
+            return inner;
+        }
+
+        ext::optional<size_t> lhs = parseValue();
+        if (!lhs) {
+            return ext::nullopt;
+        }
+
+        Operator op;
+        if (consume("==")) {
+            op = Operator::Equal;
+        } else if (consume("!=")) {
+            op = Operator::NotEqual;
+        } else {
+            return lhs;
+        }
+
+        ext::optional<size_t> rhs = parseValue();
+        if (!rhs) {
+            return ext::nullopt;
+        }
+        return add(op, *lhs, *rhs);
+    }
+
+    ext::optional<size_t> parseValue()
+    {
+        skipWhitespace();
+        if (_offset >= _expression.size()) {
+            return ext::nullopt;
+        }
+
+        /* Quoted values extend to the matching quote. */
+        char quote = _expression[_offset];
+        if (quote == '\'' || quote == '"') {
+            size_t end = _expression.find(quote, _offset + 1);
+            if (end == std::string::npos) {
+                return ext::nullopt;
+            }
+
+            std::string value = _expression.substr(_offset + 1, end - _offset - 1);
+            _offset = end + 1;
+            return add(Operator::Value, 0, 0, pbxsetting::Value::Parse(value));
+        }
+
+        /* Bare values extend to whitespace or an operator, skipping over setting references. */
+        size_t start = _offset;
+        int depth = 0;
+        while (_offset < _expression.size() && (depth > 0 || !atOperator())) {
+            char c = _expression[_offset];
+            if (c == '$' && _offset + 1 < _expression.size() && (_expression[_offset + 1] == '(' || _expression[_offset + 1] == '{')) {
+                depth++;
+                _offset++;
+            } else if (depth > 0 && (c == ')' || c == '}')) {
+                depth--;
+            }
+            _offset++;
+        }
+
+        if (depth != 0 || _offset == start) {
+            return ext::nullopt;
+        }
+
+        std::string value = _expression.substr(start, _offset - start);
+        return add(Operator::Value, 0, 0, pbxsetting::Value::Parse(value));
+    }
+};
+
+ext::optional<Tool::Condition> Tool::Condition::
+Parse(std::string const &expression)
+{
+    Parser parser = Parser(expression);
+
+    ext::optional<size_t> root = parser.parse();
+    if (!root) {
+        return ext::nullopt;
+    }
+
+    return Tool::Condition(parser.nodes(), *root);
+}
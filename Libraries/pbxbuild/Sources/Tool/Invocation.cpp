@@ -18,6 +18,71 @@ using Executable = Tool::Invocation::Executable;
 using libutil::Filesystem;
 using libutil::FSUtil;
 
+size_t Tool::Invocation::ArgumentsHash::
+operator()(std::vector<std::string> const &arguments) const
+{
+    std::hash<std::string> hash;
+
+    size_t result = arguments.size();
+    for (std::string const &argument : arguments) {
+        result = result * 31 + hash(argument);
+    }
+    return result;
+}
+
+size_t Tool::Invocation::EnvironmentHash::
+operator()(std::unordered_map<std::string, std::string> const &environment) const
+{
+    std::hash<std::string> hash;
+
+    /* Combine without depending on order, since equal maps can iterate differently. */
+    size_t result = environment.size();
+    for (auto const &entry : environment) {
+        result += hash(entry.first) * 31 + hash(entry.second);
+    }
+    return result;
+}
+
+Tool::Invocation::Arguments::
+Arguments()
+{
+}
+
+Tool::Invocation::Arguments::
+Arguments(std::vector<std::string> const &arguments) :
+    _suffix(arguments)
+{
+}
+
+Tool::Invocation::Arguments::
+Arguments(std::vector<std::string> &&arguments) :
+    _suffix(std::move(arguments))
+{
+}
+
+Tool::Invocation::Arguments::
+Arguments(std::initializer_list<std::string> arguments) :
+    _suffix(arguments)
+{
+}
+
+Tool::Invocation::Arguments::
+Arguments(SharedArguments const &prefix, std::vector<std::string> const &suffix) :
+    _prefix(prefix),
+    _suffix(suffix)
+{
+}
+
+std::vector<std::string> Tool::Invocation::Arguments::
+value() const
+{
+    std::vector<std::string> arguments;
+    arguments.reserve(size());
+    arguments.insert(arguments.end(), _prefix.begin(), _prefix.end());
+    arguments.insert(arguments.end(), _suffix.begin(), _suffix.end());
+    return arguments;
+}
+
 DependencyInfo::
 DependencyInfo(dependency::DependencyInfoFormat format, std::string const &path) :
     _format(format),
@@ -67,7 +132,8 @@ Tool::Invocation::
 Invocation() :
     _showEnvironmentInLog   (true),
     _createsProductStructure(false),
-    _waitForSwiftArtifacts  (false)
+    _waitForSwiftArtifacts  (false),
+    _priority               (0)
 {
 }
 
@@ -153,7 +153,7 @@ LoadWorkspaceProjects(Filesystem const *filesystem, std::vector<pbxproj::PBX::Pr
 
 static void
 LoadConfigurationFiles(
-    Filesystem const *filesystem,
+    pbxsetting::XC::Config::Loader *configLoader,
     std::unordered_map<pbxproj::XC::BuildConfiguration::shared_ptr, pbxsetting::XC::Config> *configs,
     pbxsetting::Environment const &environment,
     pbxproj::XC::ConfigurationList::shared_ptr const &configurationList)
@@ -170,7 +170,7 @@ LoadConfigurationFiles(
             std::string configurationPath = environment.expand(configurationReference->resolve());
 
             /* Load the configuration file. */
-            if (ext::optional<pbxsetting::XC::Config> configuration = pbxsetting::XC::Config::Load(filesystem, environment, configurationPath)) {
+            if (ext::optional<pbxsetting::XC::Config> configuration = configLoader->load(environment, configurationPath)) {
                 configs->insert({ buildConfiguration, *configuration });
             }
         }
@@ -180,6 +180,7 @@ LoadConfigurationFiles(
 static void
 LoadNestedProjects(
     Filesystem const *filesystem,
+    pbxsetting::XC::Config::Loader *configLoader,
     std::vector<pbxproj::PBX::Project::shared_ptr> *projects,
     std::unordered_map<pbxproj::XC::BuildConfiguration::shared_ptr, pbxsetting::XC::Config> *configs,
     pbxsetting::Environment const &baseEnvironment,
@@ -202,9 +203,9 @@ LoadNestedProjects(
         /*
          * Load project and target configurations.
          */
-        LoadConfigurationFiles(filesystem, configs, environment, project->buildConfigurationList());
+        LoadConfigurationFiles(configLoader, configs, environment, project->buildConfigurationList());
         for (pbxproj::PBX::Target::shared_ptr const &target : project->targets()) {
-            LoadConfigurationFiles(filesystem, configs, environment, target->buildConfigurationList());
+            LoadConfigurationFiles(configLoader, configs, environment, target->buildConfigurationList());
         }
 
         /*
@@ -233,7 +234,7 @@ LoadNestedProjects(
         /*
          * Load nested projects of the nested projects.
          */
-        LoadNestedProjects(filesystem, projects, configs, baseEnvironment, nestedProjects);
+        LoadNestedProjects(filesystem, configLoader, projects, configs, baseEnvironment, nestedProjects);
     }
 }
 
@@ -288,7 +289,8 @@ Workspace(Filesystem const *filesystem, std::string const &userName, pbxsetting:
     /*
      * Recursively load nested projects within those projects.
      */
-    LoadNestedProjects(filesystem, &projects, &configs, baseEnvironment, projects);
+    pbxsetting::XC::Config::Loader configLoader(filesystem);
+    LoadNestedProjects(filesystem, &configLoader, &projects, &configs, baseEnvironment, projects);
 
     /*
      * Load schemes for all projects, including nested projects.
@@ -318,7 +320,8 @@ Project(Filesystem const *filesystem, std::string const &userName, pbxsetting::E
     /*
      * Recursively load nested projects within the project.
      */
-    LoadNestedProjects(filesystem, &projects, &configs, baseEnvironment, projects);
+    pbxsetting::XC::Config::Loader configLoader(filesystem);
+    LoadNestedProjects(filesystem, &configLoader, &projects, &configs, baseEnvironment, projects);
 
     /*
      * Load schemes for all projects, including the root and nested projects.
@@ -0,0 +1,143 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/ClangResolver.h>
+#include <pbxbuild/Tool/CompilationInfo.h>
+#include <pbxbuild/Tool/Context.h>
+#include <pbxbuild/Tool/Input.h>
+#include <pbxbuild/Tool/PrecompiledHeaderInfo.h>
+#include <pbxbuild/Tool/SearchPaths.h>
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Setting.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <algorithm>
+
+namespace Tool = pbxbuild::Tool;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+/*
+ * A spec manager with just a compiler and a source file type.
+ */
+static pbxspec::Manager::shared_ptr
+SpecManager()
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("specs", {
+            MemoryFilesystem::Entry::File("compiler.xcspec", Contents(
+                "{ Type = Compiler; Identifier = \"com.apple.compilers.llvm.clang.1_0.compiler\"; Name = Clang; ExecPath = clang; }")),
+            MemoryFilesystem::Entry::File("filetype.xcspec", Contents(
+                "{ Type = FileType; Identifier = \"sourcecode.c.c\"; GccDialectName = c; }")),
+        }),
+    });
+
+    auto specManager = pbxspec::Manager::Create();
+    specManager->registerDomains(&filesystem, { { "domain", filesystem.path("specs") } });
+    return specManager;
+}
+
+static pbxsetting::Environment
+Environment()
+{
+    pbxsetting::Environment environment;
+    environment.insertBack(pbxsetting::Level({
+        pbxsetting::Setting::Create("variant", "normal"),
+        pbxsetting::Setting::Create("arch", "x86_64"),
+        pbxsetting::Setting::Create("PRODUCT_NAME", "Product"),
+        pbxsetting::Setting::Create("PRECOMP_DESTINATION_DIR", "/build/PrefixHeaders"),
+        pbxsetting::Setting::Create("GCC_PREFIX_HEADER", "/source/Prefix.h"),
+        pbxsetting::Setting::Create("GCC_PRECOMPILE_PREFIX_HEADER", "YES"),
+    }), false);
+    return environment;
+}
+
+/*
+ * The compile invocation for a source file.
+ */
+static Tool::Invocation const *
+FindCompile(Tool::Context const &toolContext, std::string const &path)
+{
+    auto it = std::find_if(toolContext.invocations().begin(), toolContext.invocations().end(), [&](Tool::Invocation const &invocation) {
+        return std::find(invocation.inputs().begin(), invocation.inputs().end(), path) != invocation.inputs().end();
+    });
+    return (it != toolContext.invocations().end() ? &*it : nullptr);
+}
+
+TEST(ClangResolver, SharedPrefix)
+{
+    auto specManager = SpecManager();
+    auto fileType = specManager->fileType("sourcecode.c.c", { "domain" });
+    ASSERT_NE(nullptr, fileType);
+
+    auto resolver = Tool::ClangResolver::Create(specManager, { "domain" }, "com.apple.compilers.llvm.clang.1_0");
+    ASSERT_NE(nullptr, resolver);
+
+    Tool::Context toolContext = Tool::Context(nullptr, { }, "/source", Tool::SearchPaths({ }, { }, { }, { }));
+    pbxsetting::Environment environment = Environment();
+
+    resolver->resolveSource(&toolContext, environment, Tool::Input("/source/first.c", fileType), "/build/Objects");
+    resolver->resolveSource(&toolContext, environment, Tool::Input("/source/second.c", fileType), "/build/Objects");
+
+    /* Sources with the same variant, architecture, and file type share their arguments. */
+    Tool::Invocation const *first = FindCompile(toolContext, "/source/first.c");
+    Tool::Invocation const *second = FindCompile(toolContext, "/source/second.c");
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    EXPECT_FALSE(first->arguments().prefix().empty());
+    EXPECT_EQ(first->arguments().prefix(), second->arguments().prefix());
+    EXPECT_EQ(first->environment(), second->environment());
+
+    /* And one precompiled header. */
+    EXPECT_EQ(1, toolContext.compilationInfo().precompiledHeaderInfo().size());
+    EXPECT_EQ(first->inputDependencies(), second->inputDependencies());
+}
+
+TEST(ClangResolver, CompilerFlagsNotShared)
+{
+    auto specManager = SpecManager();
+    auto fileType = specManager->fileType("sourcecode.c.c", { "domain" });
+    ASSERT_NE(nullptr, fileType);
+
+    auto resolver = Tool::ClangResolver::Create(specManager, { "domain" }, "com.apple.compilers.llvm.clang.1_0");
+    ASSERT_NE(nullptr, resolver);
+
+    Tool::Context toolContext = Tool::Context(nullptr, { }, "/source", Tool::SearchPaths({ }, { }, { }, { }));
+    pbxsetting::Environment environment = Environment();
+
+    Tool::Input flagged = Tool::Input("/source/flagged.c", fileType, nullptr, ext::nullopt, ext::nullopt, ext::nullopt, ext::nullopt, std::vector<std::string>({ "-DFLAGGED" }));
+    resolver->resolveSource(&toolContext, environment, Tool::Input("/source/plain.c", fileType), "/build/Objects");
+    resolver->resolveSource(&toolContext, environment, flagged, "/build/Objects");
+    resolver->resolveSource(&toolContext, environment, Tool::Input("/source/other.c", fileType), "/build/Objects");
+
+    Tool::Invocation const *plain = FindCompile(toolContext, "/source/plain.c");
+    Tool::Invocation const *flaggedCompile = FindCompile(toolContext, "/source/flagged.c");
+    Tool::Invocation const *other = FindCompile(toolContext, "/source/other.c");
+    ASSERT_NE(nullptr, plain);
+    ASSERT_NE(nullptr, flaggedCompile);
+    ASSERT_NE(nullptr, other);
+
+    /* Per-file flags are only passed to that file's compile. */
+    std::vector<std::string> flaggedArguments = flaggedCompile->arguments().value();
+    std::vector<std::string> plainArguments = plain->arguments().value();
+    EXPECT_NE(flaggedArguments.end(), std::find(flaggedArguments.begin(), flaggedArguments.end(), "-DFLAGGED"));
+    EXPECT_EQ(plainArguments.end(), std::find(plainArguments.begin(), plainArguments.end(), "-DFLAGGED"));
+
+    /* The flagged file gets its own precompiled header, and doesn't replace the shared one. */
+    EXPECT_EQ(2, toolContext.compilationInfo().precompiledHeaderInfo().size());
+    EXPECT_NE(plain->inputDependencies(), flaggedCompile->inputDependencies());
+    EXPECT_EQ(plain->inputDependencies(), other->inputDependencies());
+}
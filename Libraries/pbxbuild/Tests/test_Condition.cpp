@@ -0,0 +1,87 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/Condition.h>
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Setting.h>
+
+namespace Tool = pbxbuild::Tool;
+
+static bool
+Evaluate(std::string const &expression, std::vector<pbxsetting::Setting> const &settings = { })
+{
+    pbxsetting::Environment environment;
+    environment.insertBack(pbxsetting::Level(settings), false);
+
+    ext::optional<Tool::Condition> condition = Tool::Condition::Parse(expression);
+    EXPECT_TRUE(condition) << expression;
+    return condition && condition->evaluate(environment);
+}
+
+TEST(Condition, Comparison)
+{
+    EXPECT_TRUE(Evaluate("$(A) == YES", { pbxsetting::Setting::Create("A", "YES") }));
+    EXPECT_FALSE(Evaluate("$(A) == YES", { pbxsetting::Setting::Create("A", "NO") }));
+    EXPECT_TRUE(Evaluate("$(A) != bitcode", { pbxsetting::Setting::Create("A", "marker") }));
+    EXPECT_TRUE(Evaluate("$(A) == 'mh_dylib'", { pbxsetting::Setting::Create("A", "mh_dylib") }));
+    EXPECT_TRUE(Evaluate("$(A) == \"two words\"", { pbxsetting::Setting::Create("A", "two words") }));
+    EXPECT_TRUE(Evaluate("$(A)==$(B)", { pbxsetting::Setting::Create("A", "x"), pbxsetting::Setting::Create("B", "x") }));
+    EXPECT_TRUE(Evaluate("$(UNDEFINED) == ''"));
+}
+
+TEST(Condition, Logical)
+{
+    std::vector<pbxsetting::Setting> settings = {
+        pbxsetting::Setting::Create("ENABLE_BITCODE", "YES"),
+        pbxsetting::Setting::Create("BITCODE_GENERATION_MODE", "bitcode"),
+        pbxsetting::Setting::Create("MACH_O_TYPE", "mh_execute"),
+    };
+
+    EXPECT_TRUE(Evaluate("$(ENABLE_BITCODE) == YES && $(BITCODE_GENERATION_MODE) == 'bitcode' && $(MACH_O_TYPE) != 'mh_object'", settings));
+    EXPECT_FALSE(Evaluate("$(ENABLE_BITCODE) == NO  ||  $(BITCODE_GENERATION_MODE) != bitcode", settings));
+    EXPECT_TRUE(Evaluate("$(ENABLE_BITCODE) == NO || $(MACH_O_TYPE) == mh_execute", settings));
+
+    /* `&&` binds tighter than `||`. */
+    EXPECT_TRUE(Evaluate("YES || NO && NO"));
+    EXPECT_FALSE(Evaluate("(YES || NO) && NO"));
+}
+
+TEST(Condition, Not)
+{
+    EXPECT_TRUE(Evaluate("!$(A)", { pbxsetting::Setting::Create("A", "NO") }));
+    EXPECT_FALSE(Evaluate("!$(A)", { pbxsetting::Setting::Create("A", "YES") }));
+    EXPECT_TRUE(Evaluate("!($(A) == x && $(B) == y)", { pbxsetting::Setting::Create("A", "x"), pbxsetting::Setting::Create("B", "z") }));
+    EXPECT_TRUE(Evaluate("!!YES"));
+}
+
+TEST(Condition, Value)
+{
+    EXPECT_TRUE(Evaluate("$(A)", { pbxsetting::Setting::Create("A", "YES") }));
+    EXPECT_FALSE(Evaluate("$(A)", { pbxsetting::Setting::Create("A", "NO") }));
+
+    /* Only exactly `NO` is false. */
+    EXPECT_TRUE(Evaluate("$(A)", { pbxsetting::Setting::Create("A", "no") }));
+    EXPECT_TRUE(Evaluate("$(A)", { pbxsetting::Setting::Create("A", "0") }));
+    EXPECT_TRUE(Evaluate("$(UNDEFINED)"));
+    EXPECT_FALSE(Evaluate("!$(UNDEFINED)"));
+    EXPECT_TRUE(Evaluate("$(A:upper) == YES", { pbxsetting::Setting::Create("A", "yes") }));
+    EXPECT_TRUE(Evaluate("$(A_$(B)) == value", { pbxsetting::Setting::Create("A_b", "value"), pbxsetting::Setting::Create("B", "b") }));
+}
+
+TEST(Condition, Invalid)
+{
+    EXPECT_FALSE(Tool::Condition::Parse(""));
+    EXPECT_FALSE(Tool::Condition::Parse("$(A) =="));
+    EXPECT_FALSE(Tool::Condition::Parse("($(A) == YES"));
+    EXPECT_FALSE(Tool::Condition::Parse("$(A) == YES)"));
+    EXPECT_FALSE(Tool::Condition::Parse("$(A) == 'YES"));
+    EXPECT_FALSE(Tool::Condition::Parse("$(A) && || $(B)"));
+}
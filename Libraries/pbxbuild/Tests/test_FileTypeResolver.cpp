@@ -0,0 +1,113 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/FileTypeResolver.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxbuild::FileTypeResolver;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+/*
+ * Create a spec manager with file types defined inline.
+ */
+static pbxspec::Manager::shared_ptr
+Manager(MemoryFilesystem *filesystem, std::string const &specifications)
+{
+    filesystem->write(Contents(specifications), filesystem->path("FileTypes.xcspec"));
+
+    pbxspec::Manager::shared_ptr manager = pbxspec::Manager::Create();
+    manager->registerDomains(filesystem, { { "default", filesystem->path("FileTypes.xcspec") } });
+    return manager;
+}
+
+static std::string
+Identifier(pbxspec::PBX::FileType::shared_ptr const &fileType)
+{
+    return (fileType != nullptr ? fileType->identifier() : "<none>");
+}
+
+TEST(FileTypeResolver, Match)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+    pbxspec::Manager::shared_ptr manager = Manager(&filesystem,
+        "("
+        "    { Type = FileType; Identifier = file; },"
+        "    { Type = FileType; Identifier = folder; IsFolder = YES; },"
+        "    { Type = FileType; Identifier = text; BasedOn = file; Extensions = ( txt ); },"
+        "    { Type = FileType; Identifier = sourcecode.c; BasedOn = text; Extensions = ( c, h ); },"
+        "    { Type = FileType; Identifier = sourcecode.c.objc; BasedOn = sourcecode.c; Extensions = ( m ); },"
+        "    { Type = FileType; Identifier = sourcecode.asm; BasedOn = text; Extensions = ( s ); },"
+        "    { Type = FileType; Identifier = sourcecode.make; BasedOn = text; Prefix = ( Makefile, GNUmakefile ); },"
+        "    { Type = FileType; Identifier = text.xcconfig; BasedOn = text; FilenamePatterns = ( \"*.xcconfig\" ); },"
+        ")");
+    std::vector<std::string> domains = { pbxspec::Manager::AnyDomain() };
+
+    EXPECT_EQ("sourcecode.c", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/main.c")));
+    EXPECT_EQ("sourcecode.c.objc", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/main.m")));
+    EXPECT_EQ("text", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/README.txt")));
+
+    /* Extensions match case insensitively. */
+    EXPECT_EQ("sourcecode.asm", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/start.S")));
+
+    /* Prefixes match the start of the file name only. */
+    EXPECT_EQ("sourcecode.make", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/Makefile")));
+    EXPECT_EQ("sourcecode.make", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/GNUmakefile.in")));
+    EXPECT_EQ("file", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/Makefile/Other")));
+
+    EXPECT_EQ("text.xcconfig", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/Debug.xcconfig")));
+
+    /* Unknown files fall back to the generic file type. */
+    EXPECT_EQ("file", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/unknown.bin")));
+    EXPECT_EQ("file", Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, "/src/noextension")));
+}
+
+TEST(FileTypeResolver, MagicWord)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("data.plist", Contents("bplist00....")),
+        MemoryFilesystem::Entry::File("short.bin", Contents("bp")),
+        MemoryFilesystem::Entry::File("archive", Contents("!<arch>\nrest")),
+    });
+    pbxspec::Manager::shared_ptr manager = Manager(&filesystem,
+        "("
+        "    { Type = FileType; Identifier = file; },"
+        "    { Type = FileType; Identifier = folder; IsFolder = YES; },"
+        "    { Type = FileType; Identifier = file.bplist; BasedOn = file; MagicWord = ( \"bplist00\" ); },"
+        "    { Type = FileType; Identifier = archive.ar; BasedOn = file; MagicWord = ( \"!<arch>\" ); },"
+        ")");
+    std::vector<std::string> domains = { pbxspec::Manager::AnyDomain() };
+
+    std::vector<std::string> paths = {
+        filesystem.path("data.plist"),
+        filesystem.path("short.bin"),
+        filesystem.path("archive"),
+        filesystem.path("missing"),
+    };
+    std::vector<std::string> expected = { "file.bplist", "file", "archive.ar", "file" };
+
+    /* Header is read once, as long as the longest magic word. */
+    std::vector<FileTypeResolver::Sniff> sniffs = FileTypeResolver::Sniff::Read(&filesystem, manager, domains, paths);
+    ASSERT_EQ(paths.size(), sniffs.size());
+    ASSERT_NE(ext::nullopt, sniffs[0].header());
+    EXPECT_EQ(Contents("bplist00"), *sniffs[0].header());
+    EXPECT_EQ(Contents("bp"), *sniffs[1].header());
+    EXPECT_FALSE(sniffs[3].readable());
+
+    for (size_t n = 0; n < paths.size(); ++n) {
+        EXPECT_EQ(expected[n], Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, paths[n])));
+        EXPECT_EQ(expected[n], Identifier(FileTypeResolver::Resolve(&filesystem, manager, domains, paths[n], &sniffs[n])));
+    }
+}
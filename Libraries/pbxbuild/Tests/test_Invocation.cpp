@@ -0,0 +1,44 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/Invocation.h>
+
+namespace Tool = pbxbuild::Tool;
+
+TEST(Invocation, Arguments)
+{
+    Tool::Invocation::Arguments arguments = { "-c", "input.c" };
+    EXPECT_EQ(2, arguments.size());
+    EXPECT_TRUE(arguments.prefix().empty());
+    EXPECT_EQ(std::vector<std::string>({ "-c", "input.c" }), arguments.value());
+    EXPECT_TRUE(Tool::Invocation::Arguments().empty());
+}
+
+TEST(Invocation, SharedArguments)
+{
+    Tool::Invocation::SharedArguments prefix = { "-x", "c", "-Iinclude" };
+    Tool::Invocation::Arguments first = Tool::Invocation::Arguments(prefix, { "-c", "first.c" });
+    Tool::Invocation::Arguments second = Tool::Invocation::Arguments(prefix, { "-c", "second.c" });
+
+    /* The prefix is stored once for all of the invocations using it. */
+    EXPECT_EQ(&first.prefix().value(), &second.prefix().value());
+
+    /* Arguments read as the prefix followed by the suffix. */
+    EXPECT_EQ(5, first.size());
+    EXPECT_EQ("-Iinclude", first[2]);
+    EXPECT_EQ("first.c", first[4]);
+    EXPECT_EQ(std::vector<std::string>({ "-x", "c", "-Iinclude", "-c", "second.c" }), std::vector<std::string>(second.begin(), second.end()));
+
+    std::vector<std::string> iterated;
+    for (std::string const &argument : first) {
+        iterated.push_back(argument);
+    }
+    EXPECT_EQ(first.value(), iterated);
+}
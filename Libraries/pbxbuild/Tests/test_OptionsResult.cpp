@@ -632,6 +632,104 @@ TEST(OptionsResult, Architectures)
     }));
 }
 
+/*
+ * Test compiled options are reusable across environments.
+ */
+TEST(OptionsResult, CompiledOptions)
+{
+    std::vector<pbxspec::PBX::PropertyOption::shared_ptr> options = {
+        OPTION({
+            Name = ARCHS_ARM;
+            Architectures = ( armv7, arm64 );
+            Type = Boolean;
+            CommandLineFlag = "arm";
+        }),
+        OPTION({
+            Name = OPTIMIZATION;
+            Type = Enumeration;
+            CommandLineArgs = {
+                fast = ( "-O3" );
+                "<<otherwise>>" = ( "-O$(value)" );
+            };
+        }),
+        OPTION({
+            Name = DELETED;
+            Type = String;
+            CommandLineFlag = "-deleted";
+        }),
+    };
+
+    Tool::CompiledOptions compiled = Tool::CompiledOptions(options, { "DELETED" });
+    EXPECT_EQ(2, compiled.options().size());
+
+    auto armEnvironment = Environment({
+        pbxsetting::Setting::Create("ARCHS_ARM", "YES"),
+        pbxsetting::Setting::Create("OPTIMIZATION", "fast"),
+        pbxsetting::Setting::Create("DELETED", "value"),
+        pbxsetting::Setting::Create("arch", "arm64"),
+    });
+
+    auto armResult = Tool::OptionsResult::Create(armEnvironment, WorkingDirectory, compiled, FileType);
+    EXPECT_EQ(armResult.arguments(), std::vector<std::string>({
+        "arm",
+        "-O3",
+    }));
+
+    auto x86Environment = Environment({
+        pbxsetting::Setting::Create("ARCHS_ARM", "YES"),
+        pbxsetting::Setting::Create("OPTIMIZATION", "s"),
+        pbxsetting::Setting::Create("DELETED", "value"),
+        pbxsetting::Setting::Create("arch", "x86_64"),
+    });
+
+    auto x86Result = Tool::OptionsResult::Create(x86Environment, WorkingDirectory, compiled, FileType);
+    EXPECT_EQ(x86Result.arguments(), std::vector<std::string>({
+        "-Os",
+    }));
+}
+
+/*
+ * Test `Condition` and `CommandLineCondition` are evaluated.
+ */
+TEST(OptionsResult, Condition)
+{
+    std::vector<pbxspec::PBX::PropertyOption::shared_ptr> options = {
+        OPTION({
+            Name = ENABLED;
+            Type = Boolean;
+            Condition = "$(FEATURE) == YES && $(MODE) != 'off'";
+            CommandLineFlag = "enabled";
+        }),
+        OPTION({
+            Name = DISABLED;
+            Type = Boolean;
+            Condition = "$(FEATURE) == NO || $(MODE) == 'off'";
+            CommandLineFlag = "disabled";
+        }),
+        OPTION({
+            Name = COMMAND_LINE;
+            Type = String;
+            CommandLineCondition = "!($(MODE) == off)";
+            CommandLineFlag = "-mode";
+        }),
+    };
+
+    auto environment = Environment({
+        pbxsetting::Setting::Create("FEATURE", "YES"),
+        pbxsetting::Setting::Create("MODE", "on"),
+        pbxsetting::Setting::Create("ENABLED", "YES"),
+        pbxsetting::Setting::Create("DISABLED", "YES"),
+        pbxsetting::Setting::Create("COMMAND_LINE", "on"),
+    });
+
+    auto result = Tool::OptionsResult::Create(environment, WorkingDirectory, options, FileType);
+    EXPECT_EQ(result.arguments(), std::vector<std::string>({
+        "enabled",
+        "-mode",
+        "on",
+    }));
+}
+
 /*
 
 To test:
@@ -640,8 +738,6 @@ To test:
     PropertyOption::flattenRecursiveSearchPathsInValue()
 
 Unsupported:
-    PropertyOption::commandLineCondition()
-    PropertyOption::condition()
     PropertyOption::conditionFlavors()
     PropertyOption::isCommandInput()
     PropertyOption::isCommandOutput()
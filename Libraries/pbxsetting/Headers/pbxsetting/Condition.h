@@ -24,6 +24,12 @@ public:
     Condition(std::unordered_map<std::string, std::string> const &values);
     ~Condition();
 
+public:
+    bool operator==(Condition const &rhs) const
+    { return _values == rhs._values; }
+    bool operator!=(Condition const &rhs) const
+    { return !(*this == rhs); }
+
 public:
     friend struct std::hash<Condition>;
 
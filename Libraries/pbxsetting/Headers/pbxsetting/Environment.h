@@ -12,10 +12,14 @@
 
 #include <pbxsetting/Condition.h>
 #include <pbxsetting/Level.h>
+#include <pbxsetting/Operation.h>
+#include <pbxsetting/Symbol.h>
 
-#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace pbxsetting {
 
@@ -25,8 +29,33 @@ namespace pbxsetting {
  */
 class Environment {
 private:
-    std::list<Level> _levels;
-    size_t           _offset;
+    /*
+     * Memoized results of resolving settings, keyed by condition then by
+     * setting name. Resolving a setting from the first level does not depend
+     * on where it is referenced from, so results are safe to reuse until the
+     * levels change. Copies of an environment share the cache until either
+     * copy inserts a level.
+     */
+    struct Cache {
+        std::mutex mutex;
+        std::unordered_map<Condition, std::unordered_map<Symbol, std::string>> values;
+    };
+
+    /*
+     * An immutable, shared list of levels. Environments built from another
+     * environment share the levels behind the point they insert at, so
+     * adding a level in front of a copy does not copy any other levels.
+     */
+    struct Node {
+        Level                       level;
+        std::shared_ptr<Node const> next;
+    };
+
+private:
+    std::shared_ptr<Node const> _levels;
+    size_t                      _count;
+    size_t                      _offset;
+    std::shared_ptr<Cache>      _cache;
 
 public:
     explicit Environment();
@@ -40,6 +69,10 @@ public:
      * Evaluate a build setting in the environment.
      */
     std::string
+    resolve(Symbol const &setting, Condition const &condition) const;
+    std::string
+    resolve(Symbol const &setting) const;
+    std::string
     resolve(std::string const &setting, Condition const &condition) const;
     std::string
     resolve(std::string const &setting) const;
@@ -55,11 +88,24 @@ public:
 
 public:
     /*
-     * Computes all values for all settings present in the environment.
+     * Computes all values for all settings present in the environment. Settings
+     * are resolved once each, after the settings they refer to. Cycles between
+     * settings are reported and resolve as empty where the cycle is broken.
      */
     std::unordered_map<std::string, std::string>
     computeValues(Condition const &condition) const;
 
+public:
+    /*
+     * Creates an environment for resolving settings under a condition. Each
+     * level only has the settings that apply for the condition, and those no
+     * longer have a condition, so resolving a setting in the new environment
+     * without a condition gives the same result as resolving it here with the
+     * condition. Levels behind the last one with conditional settings are
+     * shared with this environment.
+     */
+    Environment specialize(Condition const &condition) const;
+
 public:
     /*
      * Adds a level to the environment, at the front (will override any existing
@@ -84,12 +130,18 @@ public:
 private:
     struct InheritanceContext {
         bool valid;
-        std::string setting;
-        std::list<Level>::const_iterator it;
+        Symbol setting;
+        Node const *it;
+        std::vector<Symbol> *resolving;
     };
-    std::string resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context) const;
-    std::string resolveInheritance(Condition const &condition, InheritanceContext const &context) const;
-    std::string resolveAssignment(Condition const &condition, std::string const &setting) const;
+    void resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context, std::string *result) const;
+    void resolveReference(Condition const &condition, Symbol const &setting, std::vector<Operation> const &operations, InheritanceContext const &context, std::string *result) const;
+    void resolveInheritance(Condition const &condition, InheritanceContext const &context, std::string *result) const;
+    std::string resolveAssignment(Condition const &condition, Symbol const &setting, std::vector<Symbol> *resolving) const;
+    std::string computeAssignment(Condition const &condition, Symbol const &setting, std::vector<Symbol> *resolving) const;
+
+private:
+    void insert(size_t index, Level const &level);
 };
 
 }
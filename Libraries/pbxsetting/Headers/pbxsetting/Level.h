@@ -12,11 +12,13 @@
 
 #include <pbxsetting/Condition.h>
 #include <pbxsetting/Setting.h>
+#include <pbxsetting/Symbol.h>
 #include <pbxsetting/Value.h>
 
-#include <vector>
-#include <utility>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace pbxsetting {
 
@@ -26,8 +28,17 @@ namespace pbxsetting {
  * other in order but *between* levels can refer to previous bindings.
  */
 class Level {
+private:
+    /*
+     * Maps each setting name to its bindings in this level, ordered
+     * from the last binding to the first, so the first match wins.
+     */
+    typedef std::unordered_map<Symbol, std::vector<Setting const *>> Index;
+
 private:
     std::shared_ptr<std::vector<Setting>> _settings;
+    std::shared_ptr<Index>                _index;
+    bool                                  _conditional;
 
 public:
     /*
@@ -43,13 +54,31 @@ public:
     std::vector<Setting> const &settings() const
     { return *_settings; }
 
+    /*
+     * If any of the settings in the level have a condition.
+     */
+    bool conditional() const
+    { return _conditional; }
+
 public:
     /*
-     * Fetches a setting from a level. Fails if the setting is not bound
-     * in this level, or is bound but for a condition that doesn't match.
+     * Fetches a setting from a level. Returns `nullptr` if the setting is
+     * not bound in this level, or is bound but for a condition that doesn't
+     * match. The returned value is owned by the level.
      */
-    std::pair<bool, Value>
+    Value const *
+    get(Symbol const &setting, Condition const &condition) const;
+    Value const *
     get(std::string const &setting, Condition const &condition) const;
+
+public:
+    /*
+     * Creates a level with the settings that apply for a condition. Settings
+     * with a condition that doesn't match are removed, and the rest no longer
+     * have a condition. Levels without conditional settings are returned as-is.
+     */
+    Level
+    specialize(Condition const &condition) const;
 };
 
 }
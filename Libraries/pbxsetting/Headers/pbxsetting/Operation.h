@@ -0,0 +1,65 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxsetting_Operation_h
+#define __pbxsetting_Operation_h
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace pbxsetting {
+
+/*
+ * An operation applied to the value of a setting reference, as in:
+ *
+ *     $(PRODUCT_NAME:rfc1034identifier)
+ *
+ * Operations are looked up by name when they are created, which happens
+ * when a value is parsed; applying one is then a direct call. Operations
+ * not known when created are looked up again each time they are applied.
+ */
+class Operation {
+public:
+    typedef std::function<std::string(std::string const &)> Function;
+
+private:
+    std::string                     _name;
+    std::shared_ptr<Function const> _function;
+
+public:
+    explicit Operation(std::string const &name);
+
+public:
+    /*
+     * The name of the operation.
+     */
+    std::string const &name() const
+    { return _name; }
+
+public:
+    /*
+     * Applies the operation to a value. Unknown operations warn and
+     * return the value unchanged.
+     */
+    std::string
+    apply(std::string const &value) const;
+
+public:
+    /*
+     * Adds or replaces an operation. Operations that were already
+     * created keep using the function they found, if any.
+     */
+    static void
+    Register(std::string const &name, Function const &function);
+};
+
+}
+
+#endif  // !__pbxsetting_Operation_h
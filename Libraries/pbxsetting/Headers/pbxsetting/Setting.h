@@ -11,6 +11,7 @@
 #define __pbxsetting_Setting_h
 
 #include <pbxsetting/Condition.h>
+#include <pbxsetting/Symbol.h>
 #include <pbxsetting/Value.h>
 
 #include <string>
@@ -23,12 +24,13 @@ namespace pbxsetting {
  */
 class Setting {
 private:
-    std::string _name;
+    Symbol      _name;
     Condition   _condition;
     Value       _value;
 
 public:
     Setting(std::string const &name, Condition const &condition, Value const &value);
+    Setting(Symbol const &name, Condition const &condition, Value const &value);
     ~Setting();
 
 public:
@@ -36,6 +38,12 @@ public:
      * The name of the setting being set.
      */
     std::string const &name() const
+    { return _name.string(); }
+
+    /*
+     * The interned name of the setting being set.
+     */
+    Symbol const &symbol() const
     { return _name; }
 
     /*
@@ -56,6 +64,8 @@ public:
      * evaluation goes through `Condition::match()`.
      */
     bool
+    match(Symbol const &name, Condition const &condition) const;
+    bool
     match(std::string const &name, Condition const &condition) const;
 
 public:
@@ -0,0 +1,66 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __pbxsetting_Symbol_h
+#define __pbxsetting_Symbol_h
+
+#include <functional>
+#include <string>
+
+namespace pbxsetting {
+
+/*
+ * An interned build setting name. Each distinct name is stored once for
+ * the lifetime of the process, so symbols are cheap to copy, compare and
+ * hash: all three operate on the address of the interned string.
+ */
+class Symbol {
+private:
+    std::string const *_string;
+
+public:
+    /*
+     * Creates a symbol for the empty name.
+     */
+    Symbol();
+
+    /*
+     * Creates a symbol for a name, interning it if it is new.
+     */
+    explicit Symbol(std::string const &string);
+
+public:
+    bool operator==(Symbol const &rhs) const
+    { return _string == rhs._string; }
+    bool operator!=(Symbol const &rhs) const
+    { return _string != rhs._string; }
+
+public:
+    /*
+     * The name the symbol stands for.
+     */
+    std::string const &string() const
+    { return *_string; }
+
+public:
+    friend struct std::hash<Symbol>;
+};
+
+}
+
+namespace std {
+template<>
+struct hash<pbxsetting::Symbol> {
+    size_t operator()(pbxsetting::Symbol const &symbol) const {
+        return std::hash<std::string const *>()(symbol._string);
+    }
+};
+}
+
+#endif  // !__pbxsetting_Symbol_h
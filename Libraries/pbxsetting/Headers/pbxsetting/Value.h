@@ -10,9 +10,13 @@
 #ifndef __pbxsetting_Value_h
 #define __pbxsetting_Value_h
 
+#include <pbxsetting/Operation.h>
+#include <pbxsetting/Symbol.h>
+
 #include <memory>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <ext/optional>
 
 namespace plist { class Object; }
@@ -65,8 +69,64 @@ public:
         { return _value; }
     };
 
+    /*
+     * A flattened form of the value, for evaluation. Literal strings are
+     * stored together in one buffer, and references with a literal name
+     * are pre-split into the setting name and the operations applied to
+     * it. References with nested references in their name are evaluated
+     * into the output between `Begin` and `End` instructions.
+     */
+    class Program {
+    public:
+        struct Reference {
+            Symbol                 setting;
+            std::vector<Operation> operations;
+        };
+
+        struct Instruction {
+            enum class Opcode : uint8_t {
+                /* Append `length` bytes at `offset` in the literals. */
+                Literal,
+                /* Resolve the reference at index `offset`. */
+                Reference,
+                /* Start collecting a reference name in the output. */
+                Begin,
+                /* Resolve the reference name collected since `Begin`. */
+                End,
+            };
+
+            Opcode   opcode;
+            uint32_t offset;
+            uint32_t length;
+        };
+
+    private:
+        std::vector<Instruction> _instructions;
+        std::string              _literals;
+        std::vector<Reference>   _references;
+
+    public:
+        Program();
+
+    public:
+        std::vector<Instruction> const &instructions() const
+        { return _instructions; }
+        std::string const &literals() const
+        { return _literals; }
+        std::vector<Reference> const &references() const
+        { return _references; }
+
+    public:
+        /*
+         * Compiles the entries of a value into a program.
+         */
+        static std::shared_ptr<Program const>
+        Compile(std::vector<Entry> const &entries);
+    };
+
 private:
-    std::vector<Entry> _entries;
+    std::vector<Entry>             _entries;
+    std::shared_ptr<Program const> _program;
 
 public:
     Value(std::vector<Entry> const &entries);
@@ -84,6 +144,12 @@ public:
     std::vector<Entry> const &entries() const
     { return _entries; }
 
+    /*
+     * The compiled form of the value, for evaluation.
+     */
+    Program const &program() const
+    { return *_program; }
+
 public:
     /*
      * The raw representation of the value. This string will be
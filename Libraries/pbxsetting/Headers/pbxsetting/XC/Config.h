@@ -15,7 +15,11 @@
 #include <pbxsetting/Setting.h>
 #include <pbxsetting/Value.h>
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <ext/optional>
 
@@ -112,7 +116,62 @@ public:
 
 public:
     /*
-     * Load a config from a file in a filesystem.
+     * Loads configs from a filesystem, keeping the parsed configs to reuse
+     * in later loads. A parsed config is reused while the size and
+     * modification time of the file and of everything it includes are
+     * unchanged, without reading them again; if only an included config
+     * changed, just that config is parsed again. Included paths depend on
+     * the environment, so are resolved again for each load.
+     *
+     * Safe to use from multiple threads at once.
+     */
+    class Loader {
+    private:
+        struct Cached {
+            uint64_t                 size;
+            uint64_t                 modified;
+            std::vector<std::string> includes;
+            std::shared_ptr<Config>  config;
+        };
+
+    private:
+        libutil::Filesystem const              *_filesystem;
+        std::mutex                              _mutex;
+        std::unordered_map<std::string, Cached> _configs;
+
+    public:
+        explicit Loader(libutil::Filesystem const *filesystem);
+
+    public:
+        /*
+         * The filesystem configs are loaded from.
+         */
+        libutil::Filesystem const *filesystem() const
+        { return _filesystem; }
+
+    public:
+        /*
+         * Load a config, sharing it with earlier loads of the same
+         * unchanged file through this loader.
+         */
+        std::shared_ptr<Config>
+        loadShared(Environment const &environment, std::string const &path);
+
+        /*
+         * Load a config.
+         */
+        ext::optional<Config>
+        load(Environment const &environment, std::string const &path);
+
+    private:
+        std::shared_ptr<Config>
+        revalidate(Environment const &environment, Cached const &cached, bool *stale);
+    };
+
+public:
+    /*
+     * Load a config from a file in a filesystem. To reuse parsed configs
+     * between loads, use a `Loader`.
      */
     static ext::optional<Config>
     Load(libutil::Filesystem const *filesystem, Environment const &environment, std::string const &path);
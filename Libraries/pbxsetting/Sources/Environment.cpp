@@ -8,7 +8,6 @@
  */
 
 #include <pbxsetting/Environment.h>
-#include <libutil/FSUtil.h>
 
 #include <algorithm>
 #include <sstream>
@@ -16,184 +15,170 @@
 using pbxsetting::Environment;
 using pbxsetting::Level;
 using pbxsetting::Condition;
+using pbxsetting::Operation;
 using pbxsetting::Setting;
+using pbxsetting::Symbol;
 using pbxsetting::Value;
-using libutil::FSUtil;
 
 Environment::
 Environment() :
-    _offset(0)
+    _count (0),
+    _offset(0),
+    _cache (std::make_shared<Cache>())
 {
 }
 
-static std::string
-ProcessOperation(std::string const &value, std::string const &operation)
+void Environment::
+resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context, std::string *result) const
 {
-    const std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    const std::string digits = "0123456789";
-
-    if (operation == "identifier" || operation == "c99extidentifier") {
-        // TODO(grp): Support c99extidentifier correctly. Requires Unicode handling.
+    using Instruction = Value::Program::Instruction;
 
-        const std::string begin = alphabet + "_";
-        const std::string subsequent = begin + digits;
+    Value::Program const &program = value.program();
+    result->reserve(result->size() + program.literals().size());
 
-        std::string result = value;
-        std::string::size_type offset = result.find_first_not_of(begin);
-        while (offset != std::string::npos) {
-            result[offset] = '_';
-            offset = result.find_first_not_of(subsequent, offset);
-        }
+    /* Offsets in the result where nested reference names begin. */
+    std::vector<std::string::size_type> names;
 
-        return result;
-    } else if (operation == "rfc1034identifier") {
-        const std::string begin = alphabet;
-        const std::string subsequent = alphabet + digits + "-";
-        const std::string end = alphabet + digits;
-
-        std::string result = value;
-        for (std::string::iterator it = result.begin(), prev = result.end(), next = (it == result.end() ? it : std::next(it)); it != result.end(); prev = it, ++it, next = (it == result.end() ? it : std::next(it))) {
-            // Cannot start or end with a dot.
-            if (prev == result.end() || next == result.end()) {
-                if (*it == '.') {
-                    *it = '-';
-                }
+    for (Instruction const &instruction : program.instructions()) {
+        switch (instruction.opcode) {
+            case Instruction::Opcode::Literal: {
+                result->append(program.literals(), instruction.offset, instruction.length);
+                break;
             }
-
-            // Cannot have digit or hyphen after dot, or hyphen before dot.
-            if (prev == result.end() || *prev == '.') {
-                if (begin.find(*it) == std::string::npos) {
-                    *it = '-';
-                }
-            } else if (next != result.end() && *next == '.') {
-                if (subsequent.find(*it) == std::string::npos) {
-                    *it = '-';
-                }
-            } else {
-                if (end.find(*it) == std::string::npos) {
-                    *it = '-';
-                }
+            case Instruction::Opcode::Reference: {
+                Value::Program::Reference const &reference = program.references()[instruction.offset];
+                resolveReference(condition, reference.setting, reference.operations, context, result);
+                break;
             }
-        }
+            case Instruction::Opcode::Begin: {
+                names.push_back(result->size());
+                break;
+            }
+            case Instruction::Opcode::End: {
+                std::string name = result->substr(names.back());
+                result->resize(names.back());
+                names.pop_back();
+
+                std::string::size_type colon = name.find(':');
+                Symbol setting = Symbol(name.substr(0, colon));
+
+                std::vector<Operation> operations;
+                while (colon != std::string::npos) {
+                    std::string::size_type next = name.find(':', colon + 1);
+                    operations.push_back(Operation(name.substr(colon + 1, next == std::string::npos ? next : next - colon - 1)));
+                    colon = next;
+                }
 
-        return result;
-    } else if (operation == "quote") {
-        // FIXME(grp): This is (probably) valid, but not necessarily compatible. Algorithm from Python's shlex.quote().
-        if (value.find_first_not_of(alphabet + digits + "@%_-+=:,./") == std::string::npos) {
-            return value;
-        } else {
-            std::string result = value;
-            std::string::size_type offset = 0;
-            while ((offset = result.find("'", offset)) != std::string::npos) {
-                result.replace(offset, 1, "'\"'\"'");
-                offset += 5;
+                resolveReference(condition, setting, operations, context, result);
+                break;
             }
-            return "'" + result + "'";
         }
-    } else if (operation == "lower") {
-        std::string result = value;
-        std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-        return result;
-    } else if (operation == "upper") {
-        std::string result = value;
-        std::transform(result.begin(), result.end(), result.begin(), ::toupper);
-        return result;
-    } else if (operation == "standardizepath") {
-        return FSUtil::NormalizePath(value);
-    } else if (operation == "base") {
-        return FSUtil::GetBaseNameWithoutExtension(value);
-    } else if (operation == "dir") {
-        return FSUtil::GetDirectoryName(value);
-    } else if (operation == "file") {
-        return FSUtil::GetBaseName(value);
-    } else if (operation == "suffix") {
-        return "." + FSUtil::GetFileExtension(value);
-    } else {
-        fprintf(stderr, "warning: unknown build setting operation '%s'\n", operation.c_str());
-        return value;
     }
 }
 
-std::string Environment::
-resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context) const
+void Environment::
+resolveReference(Condition const &condition, Symbol const &setting, std::vector<Operation> const &operations, InheritanceContext const &context, std::string *result) const
 {
-    std::string result;
-    for (auto const &entry : value.entries()) {
-        switch (entry.type()) {
-            case Value::Entry::Type::String: {
-                result += *entry.string();
-                break;
-            }
-            case Value::Entry::Type::Value: {
-                std::string resolved = resolveValue(condition, *entry.value(), context);
-                if (context.valid && (resolved == context.setting || resolved == "inherited")) {
-                    result += resolveInheritance(condition, context);
-                } else {
-                    std::string setting = resolved;
-
-                    std::string::size_type colon = resolved.find(':');
-                    if (colon != std::string::npos) {
-                        setting = resolved.substr(0, colon);
-                    }
-
-                    std::string value = resolveAssignment(condition, setting);
-
-                    while (colon != std::string::npos) {
-                        std::string::size_type next = resolved.find(':', colon + 1);
-
-                        std::string operation = resolved.substr(colon + 1, next == std::string::npos ? next : next - colon - 1);
-                        value = ProcessOperation(value, operation);
+    static Symbol const inherited = Symbol("inherited");
 
-                        colon = next;
-                    }
+    if (context.valid && operations.empty() && (setting == context.setting || setting == inherited)) {
+        resolveInheritance(condition, context, result);
+    } else if (operations.empty()) {
+        *result += resolveAssignment(condition, setting, context.resolving);
+    } else {
+        std::string value = resolveAssignment(condition, setting, context.resolving);
+        for (Operation const &operation : operations) {
+            value = operation.apply(value);
+        }
+        *result += value;
+    }
+}
 
-                    result += value;
-                }
-                break;
-            }
+void Environment::
+resolveInheritance(Condition const &condition, InheritanceContext const &context, std::string *result) const
+{
+    InheritanceContext ctx = context;
+    for (ctx.it = ctx.it->next.get(); ctx.it != nullptr; ctx.it = ctx.it->next.get()) {
+        if (Value const *value = ctx.it->level.get(ctx.setting, condition)) {
+            resolveValue(condition, *value, ctx, result);
+            return;
         }
     }
-    return result;
 }
 
 std::string Environment::
-resolveInheritance(Condition const &condition, InheritanceContext const &context) const
+resolveAssignment(Condition const &condition, Symbol const &setting, std::vector<Symbol> *resolving) const
 {
-    InheritanceContext ctx = context;
-    for (++ctx.it; ctx.it != _levels.end(); ++ctx.it) {
-        auto result = ctx.it->get(ctx.setting, condition);
-        if (result.first) {
-            return resolveValue(condition, result.second, ctx);
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+
+        auto CI = _cache->values.find(condition);
+        if (CI != _cache->values.end()) {
+            auto VI = CI->second.find(setting);
+            if (VI != CI->second.end()) {
+                return VI->second;
+            }
+        }
+    }
+
+    /*
+     * A setting that is already being resolved further up refers to itself
+     * through other settings. Report the cycle and resolve it as empty.
+     */
+    auto RI = std::find(resolving->begin(), resolving->end(), setting);
+    if (RI != resolving->end()) {
+        std::string cycle;
+        for (auto it = RI; it != resolving->end(); ++it) {
+            cycle += it->string() + " -> ";
         }
+        cycle += setting.string();
+
+        fprintf(stderr, "warning: build setting cycle: %s\n", cycle.c_str());
+        return "";
     }
 
-    return "";
+    /*
+     * Not locked while computing: resolution recurses into other settings.
+     */
+    std::string value = computeAssignment(condition, setting, resolving);
+
+    {
+        std::lock_guard<std::mutex> lock(_cache->mutex);
+        _cache->values[condition].insert({ setting, value });
+    }
+
+    return value;
 }
 
 std::string Environment::
-resolveAssignment(Condition const &condition, std::string const &setting) const
+computeAssignment(Condition const &condition, Symbol const &setting, std::vector<Symbol> *resolving) const
 {
-    InheritanceContext context = { true, setting };
-
-    for (context.it = _levels.begin(); context.it != _levels.end(); ++context.it) {
-        Level const &level = *context.it;
-        auto result = level.get(setting, condition);
-        if (result.first) {
-            return resolveValue(condition, result.second, context);
+    InheritanceContext context = { true, setting, nullptr, resolving };
+
+    for (context.it = _levels.get(); context.it != nullptr; context.it = context.it->next.get()) {
+        if (Value const *value = context.it->level.get(setting, condition)) {
+            std::string result;
+            resolving->push_back(setting);
+            resolveValue(condition, *value, context, &result);
+            resolving->pop_back();
+            return result;
         }
     }
 
     if (condition.values().empty()) {
         return "";
     } else {
-        return resolveAssignment(Condition::Empty(), setting);
+        return resolveAssignment(Condition::Empty(), setting, resolving);
     }
 }
 
 std::string Environment::
 expand(Value const &value, Condition const &condition) const
 {
-    return resolveValue(condition, value, { false });
+    std::vector<Symbol> resolving;
+    std::string result;
+    resolveValue(condition, value, { false, Symbol(), nullptr, &resolving }, &result);
+    return result;
 }
 
 std::string Environment::
@@ -202,42 +187,190 @@ expand(Value const &value) const
     return expand(value, Condition::Empty());
 }
 
+std::string Environment::
+resolve(Symbol const &setting, Condition const &condition) const
+{
+    std::vector<Symbol> resolving;
+    return resolveAssignment(condition, setting, &resolving);
+}
+
+std::string Environment::
+resolve(Symbol const &setting) const
+{
+    return resolve(setting, Condition::Empty());
+}
+
 std::string Environment::
 resolve(std::string const &setting, Condition const &condition) const
 {
-    return resolveAssignment(condition, setting);
+    return resolve(Symbol(setting), condition);
 }
 
 std::string Environment::
 resolve(std::string const &setting) const
 {
-    return resolve(setting, Condition::Empty());
+    return resolve(Symbol(setting), Condition::Empty());
 }
 
 std::unordered_map<std::string, std::string> Environment::
 computeValues(Condition const &condition) const
 {
-    std::unordered_map<std::string, std::string> values;
+    static Symbol const inherited = Symbol("inherited");
+
+    /*
+     * Collect each setting bound in any level, with the settings it refers
+     * to. Any binding can contribute to a value through inheritance, so use
+     * the references from all of them. Names built from other references
+     * are only known once resolved, and are not part of the graph.
+     */
+    std::vector<Symbol> settings;
+    std::unordered_map<Symbol, std::vector<Symbol>> graph;
+    for (Node const *node = _levels.get(); node != nullptr; node = node->next.get()) {
+        for (Setting const &setting : node->level.settings()) {
+            auto GI = graph.find(setting.symbol());
+            if (GI == graph.end()) {
+                settings.push_back(setting.symbol());
+                GI = graph.insert({ setting.symbol(), std::vector<Symbol>() }).first;
+            }
 
-    for (Level const &level : _levels) {
-        for (Setting const &setting : level.settings()) {
-            if (values.find(setting.name()) == values.end()) {
-                values[setting.name()] = resolve(setting.name(), condition);
+            if (!setting.condition().match(condition)) {
+                continue;
+            }
+
+            for (Value::Program::Reference const &reference : setting.value().program().references()) {
+                if (reference.operations.empty() && (reference.setting == setting.symbol() || reference.setting == inherited)) {
+                    continue;
+                }
+                GI->second.push_back(reference.setting);
             }
         }
     }
 
+    /*
+     * Order the settings so each comes after the settings it refers to.
+     * Resolving in that order finds every reference already resolved, so
+     * each setting is computed once and resolution never recurses deeply.
+     * Edges back to a setting still being visited are cycles; those are
+     * reported when the setting is resolved.
+     */
+    enum class Mark {
+        Visiting,
+        Visited,
+    };
+
+    std::vector<Symbol> order;
+    order.reserve(settings.size());
+
+    std::unordered_map<Symbol, Mark> marks;
+    std::vector<std::pair<Symbol, size_t>> stack;
+    for (Symbol const &root : settings) {
+        if (marks.find(root) != marks.end()) {
+            continue;
+        }
+
+        marks.insert({ root, Mark::Visiting });
+        stack.push_back({ root, 0 });
+
+        while (!stack.empty()) {
+            Symbol setting = stack.back().first;
+            size_t index = stack.back().second++;
+
+            auto GI = graph.find(setting);
+            if (GI == graph.end() || index >= GI->second.size()) {
+                marks[setting] = Mark::Visited;
+                order.push_back(setting);
+                stack.pop_back();
+                continue;
+            }
+
+            Symbol const &dependency = GI->second[index];
+            if (marks.find(dependency) == marks.end()) {
+                marks.insert({ dependency, Mark::Visiting });
+                stack.push_back({ dependency, 0 });
+            }
+        }
+    }
+
+    std::unordered_map<std::string, std::string> values;
+    values.reserve(settings.size());
+
+    for (Symbol const &setting : order) {
+        std::string value = resolve(setting, condition);
+        if (graph.find(setting) != graph.end()) {
+            values.insert({ setting.string(), std::move(value) });
+        }
+    }
+
     return values;
 }
 
+void Environment::
+insert(size_t index, Level const &level)
+{
+    _cache = std::make_shared<Cache>();
+
+    /*
+     * Levels are shared with other environments, so copy the nodes in
+     * front of the insertion point and share the ones behind it.
+     */
+    std::vector<Node const *> front;
+    front.reserve(index);
+
+    Node const *node = _levels.get();
+    for (size_t n = 0; n < index; ++n) {
+        front.push_back(node);
+        node = node->next.get();
+    }
+
+    std::shared_ptr<Node const> next = (index == 0 ? _levels : front.back()->next);
+    next = std::make_shared<Node const>(Node { level, next });
+    for (auto it = front.rbegin(); it != front.rend(); ++it) {
+        next = std::make_shared<Node const>(Node { (*it)->level, next });
+    }
+
+    _levels = next;
+    ++_count;
+}
+
+Environment Environment::
+specialize(Condition const &condition) const
+{
+    Environment environment;
+    environment._count = _count;
+    environment._offset = _offset;
+
+    /*
+     * Levels behind the last conditional level are the same in both.
+     */
+    std::shared_ptr<Node const> back = _levels;
+    for (Node const *node = _levels.get(); node != nullptr; node = node->next.get()) {
+        if (node->level.conditional()) {
+            back = node->next;
+        }
+    }
+
+    std::vector<Node const *> front;
+    for (Node const *node = _levels.get(); node != back.get(); node = node->next.get()) {
+        front.push_back(node);
+    }
+
+    std::shared_ptr<Node const> next = back;
+    for (auto it = front.rbegin(); it != front.rend(); ++it) {
+        next = std::make_shared<Node const>(Node { (*it)->level.specialize(condition), next });
+    }
+
+    environment._levels = next;
+    return environment;
+}
+
 void Environment::
 insertFront(Level const &level, bool isDefault)
 {
     if (!isDefault) {
-        _levels.push_front(level);
+        insert(0, level);
         ++_offset;
     } else {
-        _levels.insert(std::next(_levels.begin(), _offset), level);
+        insert(_offset, level);
     }
 }
 
@@ -245,10 +378,10 @@ void Environment::
 insertBack(Level const &level, bool isDefault)
 {
     if (!isDefault) {
-        _levels.insert(std::next(_levels.begin(), _offset), level);
+        insert(_offset, level);
         ++_offset;
     } else {
-        _levels.push_back(level);
+        insert(_count, level);
     }
 }
 
@@ -257,7 +390,8 @@ dump() const
 {
     size_t offset = 0;
 
-    for (Level const &level : _levels) {
+    for (Node const *node = _levels.get(); node != nullptr; node = node->next.get()) {
+        Level const &level = node->level;
         if (offset == _offset) {
             printf("=== Default Levels ===\n");
         } else if (offset == 0) {
@@ -12,12 +12,27 @@
 using pbxsetting::Level;
 using pbxsetting::Condition;
 using pbxsetting::Setting;
+using pbxsetting::Symbol;
 using pbxsetting::Value;
 
 Level::
 Level(std::vector<Setting> const &settings) :
-    _settings(std::make_shared<std::vector<Setting>>(settings))
+    _settings(std::make_shared<std::vector<Setting>>(settings)),
+    _index   (std::make_shared<Index>()),
+    _conditional(false)
 {
+    /*
+     * Build the index once. Later settings override earlier ones, so
+     * insert in reverse: the first matching binding is the one to use.
+     */
+    _index->reserve(_settings->size());
+    for (auto it = _settings->rbegin(); it != _settings->rend(); ++it) {
+        (*_index)[it->symbol()].push_back(&*it);
+
+        if (!it->condition().values().empty()) {
+            _conditional = true;
+        }
+    }
 }
 
 Level::
@@ -25,15 +40,47 @@ Level::
 {
 }
 
-std::pair<bool, Value> Level::
+Level Level::
+specialize(Condition const &condition) const
+{
+    if (!_conditional) {
+        return *this;
+    }
+
+    std::vector<Setting> settings;
+    settings.reserve(_settings->size());
+
+    for (Setting const &setting : *_settings) {
+        if (setting.condition().values().empty()) {
+            settings.push_back(setting);
+        } else if (setting.condition().match(condition)) {
+            settings.push_back(Setting(setting.symbol(), Condition::Empty(), setting.value()));
+        }
+    }
+
+    return Level(settings);
+}
+
+Value const *Level::
 get(std::string const &setting, Condition const &condition) const
 {
-    for (auto it = _settings->rbegin(); it != _settings->rend(); ++it) {
-        if (it->match(setting, condition)) {
-            return std::make_pair(true, it->value());
+    return get(Symbol(setting), condition);
+}
+
+Value const *Level::
+get(Symbol const &setting, Condition const &condition) const
+{
+    auto it = _index->find(setting);
+    if (it == _index->end()) {
+        return nullptr;
+    }
+
+    for (Setting const *binding : it->second) {
+        if (binding->condition().match(condition)) {
+            return &binding->value();
         }
     }
 
-    return std::make_pair(false, Value::Empty());
+    return nullptr;
 }
 
@@ -0,0 +1,246 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxsetting/Operation.h>
+#include <libutil/FSUtil.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+using pbxsetting::Operation;
+using libutil::FSUtil;
+
+namespace {
+
+/*
+ * A set of characters, as a table indexed by character.
+ */
+class CharacterSet {
+private:
+    bool _members[256];
+
+public:
+    explicit CharacterSet(std::string const &characters)
+    {
+        std::fill(std::begin(_members), std::end(_members), false);
+        for (char c : characters) {
+            _members[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+public:
+    bool contains(char c) const
+    { return _members[static_cast<unsigned char>(c)]; }
+};
+
+}
+
+#define ALPHABET "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+#define DIGITS   "0123456789"
+
+static std::string
+Identifier(std::string const &value)
+{
+    // TODO(grp): Support c99extidentifier correctly. Requires Unicode handling.
+    static CharacterSet const begin = CharacterSet(ALPHABET "_");
+    static CharacterSet const subsequent = CharacterSet(ALPHABET DIGITS "_");
+
+    /* Characters up to the first replaced one are checked against `begin`. */
+    std::string result = value;
+    CharacterSet const *valid = &begin;
+    for (char &c : result) {
+        if (!valid->contains(c)) {
+            c = '_';
+            valid = &subsequent;
+        }
+    }
+
+    return result;
+}
+
+static std::string
+RFC1034Identifier(std::string const &value)
+{
+    static CharacterSet const begin = CharacterSet(ALPHABET);
+    static CharacterSet const subsequent = CharacterSet(ALPHABET DIGITS "-");
+    static CharacterSet const end = CharacterSet(ALPHABET DIGITS);
+
+    std::string result = value;
+    size_t size = result.size();
+    for (size_t n = 0; n < size; ++n) {
+        char &c = result[n];
+        bool first = (n == 0);
+        bool last = (n + 1 == size);
+
+        // Cannot start or end with a dot.
+        if (first || last) {
+            if (c == '.') {
+                c = '-';
+            }
+        }
+
+        // Cannot have digit or hyphen after dot, or hyphen before dot.
+        if (first || result[n - 1] == '.') {
+            if (!begin.contains(c)) {
+                c = '-';
+            }
+        } else if (!last && result[n + 1] == '.') {
+            if (!subsequent.contains(c)) {
+                c = '-';
+            }
+        } else {
+            if (!end.contains(c)) {
+                c = '-';
+            }
+        }
+    }
+
+    return result;
+}
+
+static std::string
+Quote(std::string const &value)
+{
+    // FIXME(grp): This is (probably) valid, but not necessarily compatible. Algorithm from Python's shlex.quote().
+    static CharacterSet const safe = CharacterSet(ALPHABET DIGITS "@%_-+=:,./");
+
+    if (std::all_of(value.begin(), value.end(), [](char c) { return safe.contains(c); })) {
+        return value;
+    }
+
+    std::string result;
+    result.reserve(value.size() + 2);
+    result += '\'';
+    for (char c : value) {
+        if (c == '\'') {
+            result += "'\"'\"'";
+        } else {
+            result += c;
+        }
+    }
+    result += '\'';
+    return result;
+}
+
+#undef ALPHABET
+#undef DIGITS
+
+static std::string
+Lower(std::string const &value)
+{
+    std::string result = value;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
+static std::string
+Upper(std::string const &value)
+{
+    std::string result = value;
+    std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+static std::string
+Suffix(std::string const &value)
+{
+    return "." + FSUtil::GetFileExtension(value);
+}
+
+namespace {
+
+/*
+ * The operations available by name.
+ */
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Operation::Function const>> operations;
+};
+
+}
+
+static std::pair<std::string, std::shared_ptr<Operation::Function const>>
+Builtin(std::string const &name, Operation::Function const &function)
+{
+    return { name, std::make_shared<Operation::Function const>(function) };
+}
+
+static Registry *
+SharedRegistry()
+{
+    /* Never freed: values holding operations can outlive any other object. */
+    static Registry *registry = new Registry {
+        { },
+        {
+            Builtin("identifier", Identifier),
+            Builtin("c99extidentifier", Identifier),
+            Builtin("rfc1034identifier", RFC1034Identifier),
+            Builtin("quote", Quote),
+            Builtin("lower", Lower),
+            Builtin("upper", Upper),
+            Builtin("standardizepath", FSUtil::NormalizePath),
+            Builtin("base", FSUtil::GetBaseNameWithoutExtension),
+            Builtin("dir", FSUtil::GetDirectoryName),
+            Builtin("file", FSUtil::GetBaseName),
+            Builtin("suffix", Suffix),
+        },
+    };
+    return registry;
+}
+
+/*
+ * Functions are shared, so replacing one in the registry doesn't affect
+ * operations that are already using it.
+ */
+static std::shared_ptr<Operation::Function const>
+Lookup(std::string const &name)
+{
+    Registry *registry = SharedRegistry();
+    std::lock_guard<std::mutex> lock(registry->mutex);
+
+    auto it = registry->operations.find(name);
+    if (it != registry->operations.end()) {
+        return it->second;
+    }
+
+    return nullptr;
+}
+
+Operation::
+Operation(std::string const &name) :
+    _name    (name),
+    _function(Lookup(name))
+{
+}
+
+std::string Operation::
+apply(std::string const &value) const
+{
+    if (_function != nullptr) {
+        return (*_function)(value);
+    }
+
+    /* Not known when created, but may have been registered since. */
+    std::shared_ptr<Function const> function = Lookup(_name);
+    if (function == nullptr) {
+        fprintf(stderr, "warning: unknown build setting operation '%s'\n", _name.c_str());
+        return value;
+    }
+
+    return (*function)(value);
+}
+
+void Operation::
+Register(std::string const &name, Function const &function)
+{
+    Registry *registry = SharedRegistry();
+    std::lock_guard<std::mutex> lock(registry->mutex);
+    registry->operations[name] = std::make_shared<Function const>(function);
+}
@@ -13,10 +13,19 @@
 
 using pbxsetting::Setting;
 using pbxsetting::Condition;
+using pbxsetting::Symbol;
 using pbxsetting::Value;
 
 Setting::
 Setting(std::string const &name, Condition const &condition, Value const &value) :
+    _name(Symbol(name)),
+    _condition(condition),
+    _value(value)
+{
+}
+
+Setting::
+Setting(Symbol const &name, Condition const &condition, Value const &value) :
     _name(name),
     _condition(condition),
     _value(value)
@@ -29,11 +38,17 @@ Setting::
 }
 
 bool Setting::
-match(std::string const &name, Condition const &condition) const
+match(Symbol const &name, Condition const &condition) const
 {
     return _name == name && _condition.match(condition);
 }
 
+bool Setting::
+match(std::string const &name, Condition const &condition) const
+{
+    return _name.string() == name && _condition.match(condition);
+}
+
 Setting Setting::
 Create(std::string const &key, Value const &value)
 {
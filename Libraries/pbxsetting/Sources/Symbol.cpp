@@ -0,0 +1,54 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <pbxsetting/Symbol.h>
+
+#include <mutex>
+#include <unordered_set>
+
+using pbxsetting::Symbol;
+
+namespace {
+
+/*
+ * The interned names, split into independently locked shards by hash, so
+ * threads resolving settings concurrently rarely wait on each other.
+ */
+struct Shard {
+    std::mutex                      mutex;
+    std::unordered_set<std::string> strings;
+};
+
+}
+
+static size_t const ShardCount = 64;
+
+static std::string const *
+Intern(std::string const &string)
+{
+    /* Never freed: symbols can outlive any other object. */
+    static Shard *shards = new Shard[ShardCount];
+
+    Shard *shard = &shards[std::hash<std::string>()(string) % ShardCount];
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return &*shard->strings.insert(string).first;
+}
+
+Symbol::
+Symbol()
+{
+    static std::string const *empty = Intern(std::string());
+    _string = empty;
+}
+
+Symbol::
+Symbol(std::string const &string) :
+    _string(Intern(string))
+{
+}
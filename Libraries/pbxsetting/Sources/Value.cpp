@@ -54,9 +54,83 @@ operator!=(Entry const &entry) const
     return !(*this == entry);
 }
 
+Value::Program::
+Program()
+{
+}
+
+/*
+ * Returns the literal string a value is made of, if it has no references.
+ */
+static bool
+LiteralString(std::vector<Value::Entry> const &entries, std::string *string)
+{
+    for (Value::Entry const &entry : entries) {
+        if (entry.type() != Value::Entry::Type::String) {
+            return false;
+        }
+        *string += *entry.string();
+    }
+    return true;
+}
+
+static void
+CompileEntries(std::vector<Value::Entry> const &entries, std::vector<Value::Program::Instruction> *instructions, std::string *literals, std::vector<Value::Program::Reference> *references)
+{
+    using Instruction = Value::Program::Instruction;
+
+    for (Value::Entry const &entry : entries) {
+        switch (entry.type()) {
+            case Value::Entry::Type::String: {
+                std::string const &string = *entry.string();
+                if (!instructions->empty() && instructions->back().opcode == Instruction::Opcode::Literal) {
+                    /* Adjacent literals are always contiguous in the buffer. */
+                    instructions->back().length += string.size();
+                } else {
+                    instructions->push_back({ Instruction::Opcode::Literal, static_cast<uint32_t>(literals->size()), static_cast<uint32_t>(string.size()) });
+                }
+                *literals += string;
+                break;
+            }
+            case Value::Entry::Type::Value: {
+                std::string name;
+                if (LiteralString(entry.value()->entries(), &name)) {
+                    Value::Program::Reference reference;
+
+                    std::string::size_type colon = name.find(':');
+                    reference.setting = pbxsetting::Symbol(name.substr(0, colon));
+
+                    while (colon != std::string::npos) {
+                        std::string::size_type next = name.find(':', colon + 1);
+                        reference.operations.push_back(pbxsetting::Operation(name.substr(colon + 1, next == std::string::npos ? next : next - colon - 1)));
+                        colon = next;
+                    }
+
+                    instructions->push_back({ Instruction::Opcode::Reference, static_cast<uint32_t>(references->size()), 0 });
+                    references->push_back(std::move(reference));
+                } else {
+                    instructions->push_back({ Instruction::Opcode::Begin, 0, 0 });
+                    CompileEntries(entry.value()->entries(), instructions, literals, references);
+                    instructions->push_back({ Instruction::Opcode::End, 0, 0 });
+                }
+                break;
+            }
+        }
+    }
+}
+
+std::shared_ptr<Value::Program const> Value::Program::
+Compile(std::vector<Entry> const &entries)
+{
+    auto program = std::make_shared<Program>();
+    CompileEntries(entries, &program->_instructions, &program->_literals, &program->_references);
+    return program;
+}
+
 Value::
 Value(std::vector<Entry> const &entries) :
-    _entries(entries)
+    _entries(entries),
+    _program(Program::Compile(entries))
 {
 }
 
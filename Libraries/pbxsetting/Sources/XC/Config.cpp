@@ -98,8 +98,15 @@ ParseInclude(std::string const &value)
     }
 }
 
+static std::string
+IncludePath(Environment const &environment, std::string const &directory, Value const &include)
+{
+    std::string path = environment.expand(include);
+    return FSUtil::ResolveRelativePath(path, directory);
+}
+
 static ext::optional<Config::Entry>
-ParseDirective(Filesystem const *filesystem, Environment const &environment, std::string const &directory, std::string const &line)
+ParseDirective(Config::Loader *loader, Environment const &environment, std::string const &directory, std::string const &line, std::vector<std::string> *includes)
 {
     std::string include = "include";
     if (line.compare(1, 1 + include.size(), include)) {
@@ -107,12 +114,12 @@ ParseDirective(Filesystem const *filesystem, Environment const &environment, std
         std::string value = line.substr(1 + include.size());
         if (ext::optional<Value> parsed = ParseInclude(value)) {
             /* Determine the path on disk. */
-            std::string path = environment.expand(*parsed);
-            path = FSUtil::ResolveRelativePath(path, directory);
+            std::string path = IncludePath(environment, directory, *parsed);
+            includes->push_back(path);
 
             /* Load included config. */
-            if (ext::optional<Config> config = Config::Load(filesystem, environment, path)) {
-                return Config::Entry(*parsed, std::make_shared<Config>(*config));
+            if (std::shared_ptr<Config> config = loader->loadShared(environment, path)) {
+                return Config::Entry(*parsed, config);
             } else {
                 /* Failed to load included config. */
                 return ext::nullopt;
@@ -127,23 +134,17 @@ ParseDirective(Filesystem const *filesystem, Environment const &environment, std
     }
 }
 
-ext::optional<Config> Config::
-Load(Filesystem const *filesystem, Environment const &environment, std::string const &path)
+static ext::optional<Config>
+Parse(Config::Loader *loader, Environment const &environment, std::string const &path, std::vector<uint8_t> contents, std::vector<std::string> *includes)
 {
     std::string directory = FSUtil::GetDirectoryName(path);
 
-    /* Read in input. */
-    std::vector<uint8_t> contents;
-    if (!filesystem->read(&contents, path)) {
-        return ext::nullopt;
-    }
-
     /* Add trailing newline if missing. */
     if (contents.empty() || contents.back() != '\n') {
         contents.push_back('\n');
     }
 
-    std::vector<Entry> entries;
+    std::vector<Config::Entry> entries;
 
     bool slash = false;
     bool comment = false;
@@ -173,7 +174,7 @@ Load(Filesystem const *filesystem, Environment const &environment, std::string c
             if (!line.empty()) {
                 if (line.front() == '#') {
                     /* Parse directive. */
-                    if (ext::optional<Entry> entry = ParseDirective(filesystem, environment, directory, line)) {
+                    if (ext::optional<Config::Entry> entry = ParseDirective(loader, environment, directory, line, includes)) {
                         entries.push_back(*entry);
                     } else {
                         /* Failed to parse directive. */
@@ -191,7 +192,7 @@ Load(Filesystem const *filesystem, Environment const &environment, std::string c
 
                         /* Parse setting value. */
                         if (ext::optional<Setting> setting = Setting::Parse(line)) {
-                            Entry entry = Config::Entry(*setting);
+                            Config::Entry entry = Config::Entry(*setting);
                             entries.push_back(entry);
                         } else {
                             /* Failed to parse setting. */
@@ -212,3 +213,127 @@ Load(Filesystem const *filesystem, Environment const &environment, std::string c
     return Config(path, entries);
 }
 
+Config::Loader::
+Loader(Filesystem const *filesystem) :
+    _filesystem(filesystem)
+{
+}
+
+/*
+ * Reuses a cached config if its includes are also unchanged. When only
+ * an included config changed, the entries are relinked to it without
+ * parsing this config again.
+ */
+std::shared_ptr<Config> Config::Loader::
+revalidate(Environment const &environment, Cached const &cached, bool *stale)
+{
+    std::string directory = FSUtil::GetDirectoryName(cached.config->path());
+
+    std::vector<std::shared_ptr<Config>> configs;
+    bool changed = false;
+
+    for (Config::Entry const &entry : cached.config->contents()) {
+        if (entry.type() == Config::Entry::Type::Include) {
+            /* Included path moved; must parse again. */
+            std::string path = IncludePath(environment, directory, *entry.path());
+            if (path != cached.includes[configs.size()]) {
+                *stale = true;
+                return nullptr;
+            }
+
+            std::shared_ptr<Config> config = loadShared(environment, path);
+            if (config == nullptr) {
+                return nullptr;
+            }
+
+            changed |= (config != entry.config());
+            configs.push_back(config);
+        }
+    }
+
+    if (!changed) {
+        return cached.config;
+    }
+
+    std::vector<Config::Entry> entries;
+    auto it = configs.begin();
+    for (Config::Entry const &entry : cached.config->contents()) {
+        if (entry.type() == Config::Entry::Type::Include) {
+            entries.push_back(Config::Entry(*entry.path(), *it++));
+        } else {
+            entries.push_back(entry);
+        }
+    }
+
+    return std::make_shared<Config>(cached.config->path(), entries);
+}
+
+std::shared_ptr<Config> Config::Loader::
+loadShared(Environment const &environment, std::string const &path)
+{
+    /* Check for a previous parse of the file, unchanged since. */
+    uint64_t size;
+    uint64_t modified;
+    bool info = _filesystem->readFileInfo(path, &size, &modified);
+
+    ext::optional<Cached> cached;
+    if (info) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _configs.find(path);
+        if (it != _configs.end() && it->second.size == size && it->second.modified == modified) {
+            cached = it->second;
+        }
+    }
+
+    std::vector<std::string> includes;
+    std::shared_ptr<Config> config;
+
+    bool stale = !cached;
+    if (cached) {
+        config = revalidate(environment, *cached, &stale);
+        if (config == cached->config) {
+            return config;
+        }
+        includes = std::move(cached->includes);
+    }
+
+    if (stale) {
+        /* Read in input. */
+        std::vector<uint8_t> contents;
+        if (!_filesystem->read(&contents, path)) {
+            return nullptr;
+        }
+
+        includes.clear();
+        if (ext::optional<Config> parsed = Parse(this, environment, path, contents, &includes)) {
+            config = std::make_shared<Config>(std::move(*parsed));
+        } else {
+            config = nullptr;
+        }
+    }
+
+    /* Without the file's state, changes can't be detected later. */
+    if (config != nullptr && info) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _configs[path] = Cached { size, modified, std::move(includes), config };
+    }
+
+    return config;
+}
+
+ext::optional<Config> Config::Loader::
+load(Environment const &environment, std::string const &path)
+{
+    if (std::shared_ptr<Config> config = loadShared(environment, path)) {
+        return *config;
+    } else {
+        return ext::nullopt;
+    }
+}
+
+ext::optional<Config> Config::
+Load(Filesystem const *filesystem, Environment const &environment, std::string const &path)
+{
+    Loader loader(filesystem);
+    return loader.load(environment, path);
+}
@@ -14,6 +14,7 @@
 
 using pbxsetting::XC::Config;
 using pbxsetting::Environment;
+using pbxsetting::Level;
 using pbxsetting::Setting;
 using pbxsetting::Value;
 using libutil::Filesystem;
@@ -95,3 +96,72 @@ TEST(Config, Include)
     EXPECT_EQ(config->contents().at(0).config()->contents().at(0).setting()->value(), Value::String("VALUE"));
 }
 
+TEST(Config, Reload)
+{
+    Environment environment = Environment();
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("base.xcconfig", Contents("BASE = 1")),
+        MemoryFilesystem::Entry::File("common.xcconfig", Contents("#include \"base.xcconfig\"\nNAME = VALUE")),
+        MemoryFilesystem::Entry::File("reload.xcconfig", Contents("#include \"common.xcconfig\"\n#include \"base.xcconfig\"")),
+    });
+    Config::Loader loader(&filesystem);
+
+    auto first = loader.load(environment, filesystem.path("reload.xcconfig"));
+    ASSERT_NE(first, ext::nullopt);
+    ASSERT_EQ(first->contents().size(), 2);
+
+    /* Unchanged configs are shared. */
+    auto second = loader.load(environment, filesystem.path("reload.xcconfig"));
+    ASSERT_NE(second, ext::nullopt);
+    EXPECT_EQ(first->contents().at(0).config(), second->contents().at(0).config());
+    EXPECT_EQ(first->contents().at(1).config(), second->contents().at(1).config());
+
+    /* Files are only read again when their size or modification time changes. */
+    filesystem.root().child("base.xcconfig")->contents() = Contents("BASE = 3");
+    auto unread = loader.load(environment, filesystem.path("reload.xcconfig"));
+    ASSERT_NE(unread, ext::nullopt);
+    EXPECT_EQ(first->contents().at(1).config(), unread->contents().at(1).config());
+
+    /* Changing an included config is seen by everything including it. */
+    ASSERT_TRUE(filesystem.write(Contents("BASE = 2"), filesystem.path("base.xcconfig")));
+
+    auto third = loader.load(environment, filesystem.path("reload.xcconfig"));
+    ASSERT_NE(third, ext::nullopt);
+    EXPECT_NE(first->contents().at(0).config(), third->contents().at(0).config());
+    EXPECT_EQ(third->contents().at(0).config()->contents().at(0).config(), third->contents().at(1).config());
+
+    auto level = third->level();
+    ASSERT_EQ(level.settings().size(), 3);
+    EXPECT_EQ(level.settings().at(0).value(), Value::String("2"));
+    EXPECT_EQ(level.settings().at(1).value(), Value::String("VALUE"));
+    EXPECT_EQ(level.settings().at(2).value(), Value::String("2"));
+
+    /* Removing an included config fails the load. */
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("common.xcconfig")));
+    EXPECT_EQ(loader.load(environment, filesystem.path("reload.xcconfig")), ext::nullopt);
+}
+
+TEST(Config, ReloadEnvironment)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("a", {
+            MemoryFilesystem::Entry::File("developer.xcconfig", Contents("NAME = A")),
+        }),
+        MemoryFilesystem::Entry::Directory("b", {
+            MemoryFilesystem::Entry::File("developer.xcconfig", Contents("NAME = B")),
+        }),
+        MemoryFilesystem::Entry::File("include.xcconfig", Contents("#include \"<DEVELOPER_DIR>/developer.xcconfig\"")),
+    });
+    Config::Loader loader(&filesystem);
+
+    /* Included paths are resolved in the environment of each load. */
+    for (std::string const &developer : { "a", "b", "a" }) {
+        Environment environment = Environment();
+        environment.insertBack(Level({ Setting::Create("DEVELOPER_DIR", filesystem.path(developer)) }), false);
+
+        auto config = loader.load(environment, filesystem.path("include.xcconfig"));
+        ASSERT_NE(config, ext::nullopt);
+        ASSERT_EQ(config->contents().size(), 1);
+        EXPECT_EQ(config->contents().at(0).config()->path(), filesystem.path(developer + "/developer.xcconfig"));
+    }
+}
@@ -105,6 +105,134 @@ TEST(Environment, InheritedWithLevelInFront)
     EXPECT_EQ(inherited.resolve("OTHER_LDFLAGS"), "-ObjC -framework Security");
 }
 
+TEST(Environment, InsertAfterResolve)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("DERIVED", "$(BASE)/derived"),
+        Setting::Parse("BASE", "base"),
+    }), false);
+    EXPECT_EQ(env.resolve("DERIVED"), "base/derived");
+
+    Environment copy = Environment(env);
+    copy.insertFront(Level({
+        Setting::Parse("BASE", "override"),
+    }), false);
+    EXPECT_EQ(copy.resolve("DERIVED"), "override/derived");
+    EXPECT_EQ(env.resolve("DERIVED"), "base/derived");
+
+    env.insertBack(Level({
+        Setting::Parse("BASE", "$(inherited)"),
+    }), false);
+    env.insertFront(Level({
+        Setting::Parse("DERIVED", "$(inherited) $(BASE)"),
+    }), false);
+    EXPECT_EQ(env.resolve("DERIVED"), "base/derived base");
+}
+
+TEST(Environment, CopyShared)
+{
+    Environment base;
+    base.insertBack(Level({
+        Setting::Parse("ONE", "one"),
+    }), false);
+    base.insertBack(Level({
+        Setting::Parse("TWO", "two"),
+    }), true);
+
+    Environment front = Environment(base);
+    front.insertFront(Level({
+        Setting::Parse("ONE", "1 $(inherited)"),
+    }), false);
+
+    Environment back = Environment(base);
+    back.insertBack(Level({
+        Setting::Parse("TWO", "2"),
+        Setting::Parse("THREE", "3"),
+    }), false);
+    back.insertBack(Level({
+        Setting::Parse("THREE", "three"),
+    }), true);
+
+    EXPECT_EQ(base.resolve("ONE"), "one");
+    EXPECT_EQ(base.resolve("TWO"), "two");
+    EXPECT_EQ(base.resolve("THREE"), "");
+    EXPECT_EQ(front.resolve("ONE"), "1 one");
+    EXPECT_EQ(front.resolve("TWO"), "two");
+    EXPECT_EQ(back.resolve("ONE"), "one");
+    EXPECT_EQ(back.resolve("TWO"), "2");
+    EXPECT_EQ(back.resolve("THREE"), "3");
+}
+
+TEST(Environment, ComputeValues)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("BUILT_PRODUCTS_DIR", "$(CONFIGURATION_BUILD_DIR)"),
+        Setting::Parse("OTHER_CFLAGS", "$(inherited) -DDEBUG"),
+    }), false);
+    env.insertBack(Level({
+        Setting::Parse("CONFIGURATION_BUILD_DIR", "$(BUILD_DIR)/$(CONFIGURATION)"),
+        Setting::Parse("CONFIGURATION", "Debug"),
+        Setting::Parse("BUILD_DIR", "/build"),
+        Setting::Parse("OTHER_CFLAGS", "-Wall"),
+    }), false);
+
+    std::unordered_map<std::string, std::string> values = env.computeValues(pbxsetting::Condition::Empty());
+    EXPECT_EQ(5, values.size());
+    EXPECT_EQ("/build/Debug", values["BUILT_PRODUCTS_DIR"]);
+    EXPECT_EQ("/build/Debug", values["CONFIGURATION_BUILD_DIR"]);
+    EXPECT_EQ("Debug", values["CONFIGURATION"]);
+    EXPECT_EQ("/build", values["BUILD_DIR"]);
+    EXPECT_EQ("-Wall -DDEBUG", values["OTHER_CFLAGS"]);
+}
+
+TEST(Environment, Cycle)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("ONE", "1 $(TWO)"),
+        Setting::Parse("TWO", "2 $(THREE)"),
+        Setting::Parse("THREE", "3 $(ONE)"),
+        Setting::Parse("FOUR", "4"),
+    }), false);
+
+    EXPECT_EQ("1 2 3 ", env.resolve("ONE"));
+
+    std::unordered_map<std::string, std::string> values = env.computeValues(pbxsetting::Condition::Empty());
+    EXPECT_EQ(4, values.size());
+    EXPECT_EQ("4", values["FOUR"]);
+}
+
+TEST(Environment, Specialize)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("FLAGS", "$(inherited) $(ARCH_FLAGS)"),
+        *Setting::Parse("FLAGS[sdk=iphoneos*] = $(inherited) -device"),
+    }), false);
+    env.insertBack(Level({
+        Setting::Parse("ARCH_FLAGS", "generic"),
+        *Setting::Parse("ARCH_FLAGS[arch=arm64] = arm"),
+    }), false);
+    env.insertBack(Level({
+        Setting::Parse("FLAGS", "-base"),
+    }), false);
+
+    pbxsetting::Condition device = pbxsetting::Condition(std::unordered_map<std::string, std::string>({ { "sdk", "iphoneos10.0" }, { "arch", "arm64" } }));
+    pbxsetting::Condition simulator = pbxsetting::Condition(std::unordered_map<std::string, std::string>({ { "sdk", "iphonesimulator10.0" }, { "arch", "x86_64" } }));
+
+    Environment deviceEnvironment = env.specialize(device);
+    Environment simulatorEnvironment = env.specialize(simulator);
+
+    EXPECT_EQ(env.resolve("FLAGS", device), deviceEnvironment.resolve("FLAGS"));
+    EXPECT_EQ("-base -device", deviceEnvironment.resolve("FLAGS"));
+    EXPECT_EQ("arm", deviceEnvironment.resolve("ARCH_FLAGS"));
+
+    EXPECT_EQ(env.resolve("FLAGS", simulator), simulatorEnvironment.resolve("FLAGS"));
+    EXPECT_EQ("-base generic", simulatorEnvironment.resolve("FLAGS"));
+}
+
 TEST(Environment, Operations)
 {
     Environment environment;
@@ -0,0 +1,91 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxsetting/Level.h>
+
+using pbxsetting::Condition;
+using pbxsetting::Level;
+using pbxsetting::Setting;
+using pbxsetting::Value;
+
+TEST(Level, Get)
+{
+    Level level = Level({
+        Setting::Parse("ONE", "one"),
+        Setting::Parse("TWO", "two"),
+    });
+
+    Value const *one = level.get("ONE", Condition::Empty());
+    ASSERT_NE(nullptr, one);
+    EXPECT_EQ(Value::String("one"), *one);
+
+    EXPECT_EQ(nullptr, level.get("THREE", Condition::Empty()));
+}
+
+TEST(Level, LaterOverrides)
+{
+    Level level = Level({
+        Setting::Parse("ONE", "first"),
+        Setting::Parse("ONE", "second"),
+    });
+
+    Value const *one = level.get("ONE", Condition::Empty());
+    ASSERT_NE(nullptr, one);
+    EXPECT_EQ(Value::String("second"), *one);
+}
+
+TEST(Level, Conditional)
+{
+    Level level = Level({
+        Setting::Parse("ARCH_FLAGS", "generic"),
+        *Setting::Parse("ARCH_FLAGS[arch=x86_64] = intel"),
+        *Setting::Parse("ARCH_FLAGS[arch=arm*] = arm"),
+    });
+
+    Value const *generic = level.get("ARCH_FLAGS", Condition::Empty());
+    ASSERT_NE(nullptr, generic);
+    EXPECT_EQ(Value::String("generic"), *generic);
+
+    Value const *intel = level.get("ARCH_FLAGS", Condition(std::unordered_map<std::string, std::string>({ { "arch", "x86_64" } })));
+    ASSERT_NE(nullptr, intel);
+    EXPECT_EQ(Value::String("intel"), *intel);
+
+    Value const *arm = level.get("ARCH_FLAGS", Condition(std::unordered_map<std::string, std::string>({ { "arch", "arm64" } })));
+    ASSERT_NE(nullptr, arm);
+    EXPECT_EQ(Value::String("arm"), *arm);
+
+    Value const *other = level.get("ARCH_FLAGS", Condition(std::unordered_map<std::string, std::string>({ { "arch", "i386" } })));
+    ASSERT_NE(nullptr, other);
+    EXPECT_EQ(Value::String("generic"), *other);
+}
+
+TEST(Level, Specialize)
+{
+    Level unconditional = Level({
+        Setting::Parse("ONE", "one"),
+    });
+    EXPECT_FALSE(unconditional.conditional());
+    EXPECT_EQ(&unconditional.settings(), &unconditional.specialize(Condition::Empty()).settings());
+
+    Level level = Level({
+        Setting::Parse("ARCH_FLAGS", "generic"),
+        *Setting::Parse("ARCH_FLAGS[arch=x86_64] = intel"),
+        *Setting::Parse("ARCH_FLAGS[arch=arm*] = arm"),
+    });
+    EXPECT_TRUE(level.conditional());
+
+    Level intel = level.specialize(Condition(std::unordered_map<std::string, std::string>({ { "arch", "x86_64" } })));
+    EXPECT_FALSE(intel.conditional());
+    ASSERT_EQ(2, intel.settings().size());
+
+    Value const *flags = intel.get("ARCH_FLAGS", Condition::Empty());
+    ASSERT_NE(nullptr, flags);
+    EXPECT_EQ(Value::String("intel"), *flags);
+}
@@ -0,0 +1,71 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxsetting/Operation.h>
+
+using pbxsetting::Operation;
+
+TEST(Operation, Identifier)
+{
+    EXPECT_EQ("abc_def", Operation("identifier").apply("abc def"));
+    EXPECT_EQ("_1abc", Operation("identifier").apply("91abc"));
+    EXPECT_EQ("a_b2", Operation("identifier").apply("a1b2"));
+    EXPECT_EQ("", Operation("identifier").apply(""));
+}
+
+TEST(Operation, RFC1034Identifier)
+{
+    EXPECT_EQ("com-example-My-App", Operation("rfc1034identifier").apply("com.example.My App"));
+    EXPECT_EQ("-abc-", Operation("rfc1034identifier").apply(".abc."));
+    EXPECT_EQ("a-9b", Operation("rfc1034identifier").apply("a.9b"));
+}
+
+TEST(Operation, Quote)
+{
+    EXPECT_EQ("safe/path-1.0", Operation("quote").apply("safe/path-1.0"));
+    EXPECT_EQ("'a b'", Operation("quote").apply("a b"));
+    EXPECT_EQ("'it'\"'\"'s'", Operation("quote").apply("it's"));
+    EXPECT_EQ("'\xe2\x82\xac'", Operation("quote").apply("\xe2\x82\xac"));
+}
+
+TEST(Operation, Unknown)
+{
+    Operation operation = Operation("unknown-operation");
+    EXPECT_EQ("unknown-operation", operation.name());
+    EXPECT_EQ("value", operation.apply("value"));
+}
+
+TEST(Operation, Register)
+{
+    Operation::Register("reverse", [](std::string const &value) {
+        return std::string(value.rbegin(), value.rend());
+    });
+
+    EXPECT_EQ("cba", Operation("reverse").apply("abc"));
+}
+
+TEST(Operation, RegisterLater)
+{
+    Operation operation = Operation("later");
+    EXPECT_EQ("abc", operation.apply("abc"));
+
+    Operation::Register("later", [](std::string const &value) {
+        return value + value;
+    });
+    EXPECT_EQ("abcabc", operation.apply("abc"));
+
+    /* Replacing keeps existing operations on the function they found. */
+    Operation first = Operation("later");
+    Operation::Register("later", [](std::string const &value) {
+        return std::string();
+    });
+    EXPECT_EQ("abcabc", first.apply("abc"));
+    EXPECT_EQ("", Operation("later").apply("abc"));
+}
@@ -0,0 +1,58 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxsetting/Symbol.h>
+
+#include <thread>
+#include <vector>
+
+using pbxsetting::Symbol;
+
+TEST(Symbol, Interned)
+{
+    std::string name = "PRODUCT_NAME";
+    Symbol first = Symbol(name);
+    Symbol second = Symbol(std::string("PRODUCT_") + "NAME");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(&first.string(), &second.string());
+    EXPECT_EQ("PRODUCT_NAME", first.string());
+    EXPECT_EQ(std::hash<Symbol>()(first), std::hash<Symbol>()(second));
+
+    Symbol other = Symbol("PRODUCT_MODULE_NAME");
+    EXPECT_NE(first, other);
+}
+
+TEST(Symbol, Empty)
+{
+    EXPECT_EQ(Symbol(), Symbol(""));
+    EXPECT_EQ("", Symbol().string());
+}
+
+TEST(Symbol, Concurrent)
+{
+    /* Threads interning the same names all get the same symbols. */
+    std::vector<std::vector<Symbol>> symbols = std::vector<std::vector<Symbol>>(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < symbols.size(); t++) {
+        threads.push_back(std::thread([&symbols, t]() {
+            for (size_t n = 0; n < 1000; n++) {
+                symbols[t].push_back(Symbol("CONCURRENT_" + std::to_string(n)));
+            }
+        }));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (size_t t = 1; t < symbols.size(); t++) {
+        EXPECT_EQ(symbols[0], symbols[t]);
+    }
+    EXPECT_EQ("CONCURRENT_999", symbols[0].back().string());
+}
@@ -209,3 +209,29 @@ TEST(Value, Add)
     ASSERT_EQ(string_string.entries().at(0).type(), Value::Entry::Type::String);
     EXPECT_EQ(*string_string.entries().at(0).string(), "teststring");
 }
+
+TEST(Value, Program)
+{
+    using Instruction = Value::Program::Instruction;
+
+    Value value = Value::Parse("prefix-$(NAME:lower:quote)-$(SUFFIX_$(INDEX))");
+    Value::Program const &program = value.program();
+    EXPECT_EQ("prefix--SUFFIX_", program.literals());
+
+    ASSERT_EQ(7, program.instructions().size());
+    EXPECT_EQ(Instruction::Opcode::Literal, program.instructions().at(0).opcode);
+    EXPECT_EQ(Instruction::Opcode::Reference, program.instructions().at(1).opcode);
+    EXPECT_EQ(Instruction::Opcode::Literal, program.instructions().at(2).opcode);
+    EXPECT_EQ(Instruction::Opcode::Begin, program.instructions().at(3).opcode);
+    EXPECT_EQ(Instruction::Opcode::Literal, program.instructions().at(4).opcode);
+    EXPECT_EQ(Instruction::Opcode::Reference, program.instructions().at(5).opcode);
+    EXPECT_EQ(Instruction::Opcode::End, program.instructions().at(6).opcode);
+
+    ASSERT_EQ(2, program.references().size());
+    EXPECT_EQ("NAME", program.references().at(0).setting.string());
+    ASSERT_EQ(2, program.references().at(0).operations.size());
+    EXPECT_EQ("lower", program.references().at(0).operations.at(0).name());
+    EXPECT_EQ("quote", program.references().at(0).operations.at(1).name());
+    EXPECT_EQ("INDEX", program.references().at(1).setting.string());
+    EXPECT_TRUE(program.references().at(1).operations.empty());
+}
@@ -25,13 +25,16 @@
 #include <pbxspec/PBX/Tool.h>
 
 #include <map>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 namespace libutil { class Filesystem; }
+namespace plist { class Object; }
 
 namespace pbxspec {
 
@@ -39,11 +42,34 @@ class Manager {
 public:
     typedef std::shared_ptr <Manager> shared_ptr;
 
+private:
+    /*
+     * Specifications of one type in one domain, by identifier.
+     */
+    typedef std::unordered_map<std::string, PBX::Specification::shared_ptr> SpecificationIndex;
+
+    /*
+     * The parsed contents of a specification file, and the size and
+     * modification time of the file it was parsed from.
+     */
+    struct CachedFile {
+        uint64_t                             size;
+        uint64_t                             modified;
+        std::shared_ptr<plist::Object const> contents;
+        bool                                 used;
+    };
+
 private:
     std::unordered_set<std::string>                                                _domains;
     std::map<std::string, std::map<SpecificationType, PBX::Specification::vector>> _specifications;
+    std::map<std::string, std::map<SpecificationType, SpecificationIndex>>         _identifiers;
     PBX::BuildRule::vector                                                         _buildRules;
 
+private:
+    ext::optional<std::string>                                                     _cachePath;
+    std::unordered_map<std::string, CachedFile>                                    _cachedFiles;
+    bool                                                                           _cacheChanged;
+
 public:
     Manager();
     ~Manager();
@@ -129,6 +155,20 @@ public:
     void registerDomains(libutil::Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains);
     bool registerBuildRules(libutil::Filesystem const *filesystem, std::string const &path);
 
+public:
+    /*
+     * Use a cache of parsed specification files. Files that have the same
+     * size and modification time as when cached are not parsed again. Call
+     * before registering domains. Returns false if no cache could be read.
+     */
+    bool loadCache(libutil::Filesystem const *filesystem, std::string const &path);
+
+    /*
+     * Write the specification files used since loading the cache back to
+     * it, if any were parsed again.
+     */
+    bool saveCache(libutil::Filesystem *filesystem);
+
 private:
     void addSpecification(PBX::Specification::shared_ptr const &specification);
     bool inheritSpecification(PBX::Specification::shared_ptr const &specification, std::vector<PBX::Specification::shared_ptr>);
@@ -160,6 +200,10 @@ public:
 public:
     static std::vector<std::string>
     DeveloperBuildRules(std::string const &developerRoot);
+
+public:
+    static std::string
+    CachePath(std::string const &cacheDirectory, std::string const &developerRoot);
 };
 
 }
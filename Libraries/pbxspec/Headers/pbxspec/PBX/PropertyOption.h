@@ -10,6 +10,7 @@
 #ifndef __pbxspec_PBX_PropertyOption_h
 #define __pbxspec_PBX_PropertyOption_h
 
+#include <pbxsetting/Symbol.h>
 #include <pbxsetting/Value.h>
 
 #include <memory>
@@ -45,7 +46,7 @@ public:
     }
 
 protected:
-    std::string                              _name;
+    pbxsetting::Symbol                       _name;
     ext::optional<std::string>               _displayName;
     plist::Object                           *_displayValues;
     std::string                              _type;
@@ -91,6 +92,8 @@ public:
 
 public:
     inline std::string const &name() const
+    { return _name.string(); }
+    inline pbxsetting::Symbol const &symbol() const
     { return _name; }
     inline ext::optional<std::string> const &displayName() const
     { return _displayName; }
@@ -19,6 +19,7 @@
 #include <ext/optional>
 
 namespace libutil { class Filesystem; }
+namespace plist { class Object; }
 namespace plist { class Dictionary; }
 namespace pbxspec { class Manager; }
 namespace pbxspec { class Context; }
@@ -98,6 +99,26 @@ protected:
     static bool ParseType(Context *context, plist::Dictionary const *dict, SpecificationType expectedType);
 
 public:
+    /*
+     * Read the property list in a specification file.
+     */
+    static std::unique_ptr<plist::Object> Read(
+        libutil::Filesystem const *filesystem,
+        std::string const &filename);
+
+    /*
+     * Create the specifications in a specification file's property list.
+     * The file name is only used for errors.
+     */
+    static ext::optional<Specification::vector> Open(
+        Context *context,
+        plist::Object const *plist,
+        std::string const &filename,
+        ext::optional<SpecificationType> defaultType = ext::nullopt);
+
+    /*
+     * Read and create the specifications in a specification file.
+     */
     static ext::optional<Specification::vector> Open(
         libutil::Filesystem const *filesystem,
         Context *context,
@@ -11,10 +11,17 @@
 #include <pbxspec/Context.h>
 #include <plist/Array.h>
 #include <plist/Dictionary.h>
+#include <plist/Integer.h>
 #include <plist/Object.h>
 #include <plist/Format/Any.h>
+#include <plist/Format/Binary.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/Parallel.h>
+#include <libutil/md5.h>
+
+#include <iomanip>
+#include <sstream>
 
 using pbxspec::Manager;
 using pbxspec::Context;
@@ -24,8 +31,14 @@ namespace PBX = pbxspec::PBX;
 using libutil::Filesystem;
 using libutil::FSUtil;
 
+/*
+ * Increment when the cached property list layout changes.
+ */
+static int64_t const CacheVersion = 1;
+
 Manager::
-Manager()
+Manager() :
+    _cacheChanged(false)
 {
 }
 
@@ -70,14 +83,37 @@ template <typename T>
 typename T::shared_ptr Manager::
 findSpecification(std::vector<std::string> const &domains, std::string const &identifier, SpecificationType type) const
 {
-    typename T::vector vector = findSpecifications <T> (domains, type);
-
-    auto I = std::find_if(vector.begin(), vector.end(), [&identifier](PBX::Specification::shared_ptr const &spec) -> bool {
-        return identifier == spec->identifier();
-    });
+    /*
+     * Same precedence as searching `findSpecifications`: domains in order,
+     * then specifications in the order they were registered. Only the first
+     * specification with an identifier in each domain is indexed.
+     */
+    auto find = [&](std::map<SpecificationType, SpecificationIndex> const &types) -> PBX::Specification::shared_ptr const * {
+        auto const &it = types.find(type);
+        if (it != types.end()) {
+            auto const &iit = it->second.find(identifier);
+            if (iit != it->second.end()) {
+                return &iit->second;
+            }
+        }
+        return nullptr;
+    };
 
-    if (I != vector.end()) {
-        return *I;
+    for (std::string const &domain : domains) {
+        if (domain == AnyDomain()) {
+            for (auto const &entry : _identifiers) {
+                if (PBX::Specification::shared_ptr const *specification = find(entry.second)) {
+                    return std::static_pointer_cast<T>(*specification);
+                }
+            }
+        } else {
+            auto const &doit = _identifiers.find(domain);
+            if (doit != _identifiers.end()) {
+                if (PBX::Specification::shared_ptr const *specification = find(doit->second)) {
+                    return std::static_pointer_cast<T>(*specification);
+                }
+            }
+        }
     }
 
     return nullptr;
@@ -282,6 +318,7 @@ addSpecification(PBX::Specification::shared_ptr const &spec)
             spec->type(), spec->domain().c_str(), spec->identifier().c_str());
 #endif
     _specifications[spec->domain()][spec->type()].push_back(spec);
+    _identifiers[spec->domain()][spec->type()].insert({ spec->identifier(), spec });
 }
 
 bool Manager::
@@ -361,77 +398,145 @@ inheritSpecification(PBX::Specification::shared_ptr const &specification, std::v
     return true;
 }
 
-void Manager::
-registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains)
+namespace {
+
+/*
+ * A specification file to load, found in a domain.
+ */
+struct SpecificationFile {
+    std::string                      domain;
+    std::string                      path;
+    ext::optional<SpecificationType> defaultType;
+};
+
+}
+
+static std::vector<SpecificationFile>
+FindSpecificationFiles(Filesystem const *filesystem, std::pair<std::string, std::string> const &domain)
 {
-    PBX::Specification::vector specifications;
+    std::vector<SpecificationFile> files;
 
-    for (auto const &domain : domains) {
-        /*
-         * Avoid double domain registration. Unncessary and causes warnings.
-         */
-        if (_domains.find(domain.first) != _domains.end()) {
-            continue;
-        }
+    std::string realPath = filesystem->resolvePath(domain.second);
+    if (realPath.empty()) {
+        return files;
+    }
 
-        Context context;
-        context.domain = domain.first;
+    ext::optional<Filesystem::Type> type = filesystem->type(realPath);
+    if (!type) {
+        return files;
+    }
 
-        std::string realPath = filesystem->resolvePath(domain.second);
-        if (realPath.empty()) {
-            continue;
+    switch (*type) {
+        case Filesystem::Type::Directory: {
+            filesystem->readDirectory(realPath, true, [&](std::string const &filename) -> bool {
+                std::string path = realPath + "/" + filename;
+
+                /* Support both *.xcspec and *.pbfilespec as a few of the latter remain in use. */
+                if (FSUtil::GetFileExtension(path) != "xcspec" && FSUtil::GetFileExtension(path) != "pbfilespec") {
+                    return true;
+                }
+
+                /* For *.pbfilespec files, default to FileType specifications. */
+                ext::optional<SpecificationType> defaultType;
+                if (FSUtil::GetFileExtension(path) == "pbfilespec") {
+                    defaultType = SpecificationType::FileType;
+                }
+
+                if (filesystem->type(path) != Filesystem::Type::Directory) {
+                    files.push_back({ domain.first, path, defaultType });
+                }
+                return true;
+            });
+            break;
+        }
+        case Filesystem::Type::SymbolicLink:
+        case Filesystem::Type::File: {
+            files.push_back({ domain.first, realPath, ext::nullopt });
+            break;
         }
+    }
 
-        ext::optional<Filesystem::Type> type = filesystem->type(realPath);
-        if (!type) {
-            continue;
+    return files;
+}
+
+void Manager::
+registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string, std::string>> const &domains)
+{
+    /*
+     * Avoid double domain registration. Unncessary and causes warnings.
+     */
+    std::vector<std::pair<std::string, std::string>> unregistered;
+    for (auto const &domain : domains) {
+        if (_domains.find(domain.first) == _domains.end()) {
+            unregistered.push_back(domain);
         }
+    }
 
-        switch (*type) {
-            case Filesystem::Type::Directory: {
-                filesystem->readDirectory(realPath, true, [&](std::string const &filename) -> bool {
-                    std::string path = realPath + "/" + filename;
+    /*
+     * Find and then parse specification files in parallel. Results are kept
+     * in the order of the domains and files, so registration and inheritance
+     * below are the same no matter how the work was scheduled.
+     */
+    std::vector<std::vector<SpecificationFile>> domainFiles = std::vector<std::vector<SpecificationFile>>(unregistered.size());
+    libutil::Parallel::For(unregistered.size(), [&](size_t n) {
+        domainFiles[n] = FindSpecificationFiles(filesystem, unregistered[n]);
+    });
 
-                    /* Support both *.xcspec and *.pbfilespec as a few of the latter remain in use. */
-                    if (FSUtil::GetFileExtension(path) != "xcspec" && FSUtil::GetFileExtension(path) != "pbfilespec") {
-                        return true;
-                    }
+    std::vector<SpecificationFile> files;
+    for (std::vector<SpecificationFile> const &entries : domainFiles) {
+        files.insert(files.end(), entries.begin(), entries.end());
+    }
 
-                    /* For *.pbfilespec files, default to FileType specifications. */
-                    ext::optional<SpecificationType> defaultType;
-                    if (FSUtil::GetFileExtension(path) == "pbfilespec") {
-                        defaultType = SpecificationType::FileType;
-                    }
+    std::vector<CachedFile> fileContents = std::vector<CachedFile>(files.size());
+    std::vector<ext::optional<PBX::Specification::vector>> fileSpecifications = std::vector<ext::optional<PBX::Specification::vector>>(files.size());
+    libutil::Parallel::For(files.size(), [&](size_t n) {
+        CachedFile *file = &fileContents[n];
 
-                    if (filesystem->type(path) != Filesystem::Type::Directory) {
-#if 0
-                        fprintf(stderr, "importing specification '%s'\n", path.c_str());
-#endif
+        /* Reuse the cached contents if the file is unchanged. */
+        if (_cachePath && filesystem->readFileInfo(files[n].path, &file->size, &file->modified)) {
+            file->used = true;
 
-                        ext::optional<PBX::Specification::vector> fileSpecifications = PBX::Specification::Open(filesystem, &context, path, defaultType);
-                        if (fileSpecifications) {
-                            specifications.insert(specifications.end(), fileSpecifications->begin(), fileSpecifications->end());
-                        } else {
-                            fprintf(stderr, "warning: failed to import specification '%s'\n", path.c_str());
-                        }
-                    }
-                    return true;
-                });
-                break;
+            auto it = _cachedFiles.find(files[n].path);
+            if (it != _cachedFiles.end() && it->second.size == file->size && it->second.modified == file->modified) {
+                file->contents = it->second.contents;
             }
-            case Filesystem::Type::SymbolicLink:
-            case Filesystem::Type::File: {
+        }
+
+        if (file->contents == nullptr) {
 #if 0
-                fprintf(stderr, "importing specification '%s'\n", realPath.c_str());
+            fprintf(stderr, "importing specification '%s'\n", files[n].path.c_str());
 #endif
-                ext::optional<PBX::Specification::vector> fileSpecifications = PBX::Specification::Open(filesystem, &context, realPath);
-                if (fileSpecifications) {
-                    specifications.insert(specifications.end(), fileSpecifications->begin(), fileSpecifications->end());
-                } else {
-                    fprintf(stderr, "warning: failed to import specification '%s'\n", realPath.c_str());
-                }
-                break;
+            file->contents = PBX::Specification::Read(filesystem, files[n].path);
+        }
+
+        if (file->contents != nullptr) {
+            Context context;
+            context.domain = files[n].domain;
+            fileSpecifications[n] = PBX::Specification::Open(&context, file->contents.get(), files[n].path, files[n].defaultType);
+        }
+    });
+
+    /*
+     * Record newly parsed files in the cache. Files without a modification
+     * time can't be checked later, so aren't cached.
+     */
+    for (size_t n = 0; n < files.size(); ++n) {
+        CachedFile const &file = fileContents[n];
+        if (file.used && file.contents != nullptr) {
+            auto it = _cachedFiles.find(files[n].path);
+            if (it == _cachedFiles.end() || it->second.contents != file.contents) {
+                _cacheChanged = true;
             }
+            _cachedFiles[files[n].path] = file;
+        }
+    }
+
+    PBX::Specification::vector specifications;
+    for (size_t n = 0; n < files.size(); ++n) {
+        if (fileSpecifications[n]) {
+            specifications.insert(specifications.end(), fileSpecifications[n]->begin(), fileSpecifications[n]->end());
+        } else {
+            fprintf(stderr, "warning: failed to import specification '%s'\n", files[n].path.c_str());
         }
     }
 
@@ -492,6 +597,100 @@ registerBuildRules(Filesystem const *filesystem, std::string const &path)
     return true;
 }
 
+bool Manager::
+loadCache(Filesystem const *filesystem, std::string const &path)
+{
+    _cachePath = path;
+    _cachedFiles.clear();
+    _cacheChanged = false;
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->exists(path) || !filesystem->read(&contents, path)) {
+        return false;
+    }
+
+    std::unique_ptr<plist::Object> plist = plist::Format::Binary::Deserialize(contents, plist::Format::Binary::Create()).first;
+    plist::Dictionary const *dict = plist::CastTo <plist::Dictionary> (plist.get());
+    if (dict == nullptr) {
+        fprintf(stderr, "warning: ignoring invalid specification cache '%s'\n", path.c_str());
+        return false;
+    }
+
+    plist::Integer const *version = dict->value <plist::Integer> ("Version");
+    plist::Dictionary const *files = dict->value <plist::Dictionary> ("Files");
+    if (version == nullptr || version->value() != CacheVersion || files == nullptr) {
+        return false;
+    }
+
+    for (size_t n = 0; n < files->count(); n++) {
+        plist::Dictionary const *file = files->value <plist::Dictionary> (n);
+        if (file == nullptr) {
+            continue;
+        }
+
+        plist::Integer const *size = file->value <plist::Integer> ("Size");
+        plist::Integer const *modified = file->value <plist::Integer> ("Modified");
+        plist::Object const *fileContents = file->value("Contents");
+        if (size == nullptr || modified == nullptr || fileContents == nullptr) {
+            continue;
+        }
+
+        /* Specification files contain one specification or an array of them. */
+        if (plist::CastTo <plist::Dictionary> (fileContents) == nullptr && plist::CastTo <plist::Array> (fileContents) == nullptr) {
+            continue;
+        }
+
+        CachedFile cached = {
+            static_cast<uint64_t>(size->value()),
+            static_cast<uint64_t>(modified->value()),
+            std::shared_ptr<plist::Object const>(fileContents->copy()),
+            false,
+        };
+        _cachedFiles.insert({ files->key(n), cached });
+    }
+
+    return true;
+}
+
+bool Manager::
+saveCache(Filesystem *filesystem)
+{
+    if (!_cachePath || !_cacheChanged) {
+        return true;
+    }
+
+    /* Only files used in this process, so removed files are dropped. */
+    std::unique_ptr<plist::Dictionary> files = plist::Dictionary::New();
+    for (auto const &entry : _cachedFiles) {
+        if (entry.second.used) {
+            std::unique_ptr<plist::Dictionary> file = plist::Dictionary::New();
+            file->set("Size", plist::Integer::New(static_cast<int64_t>(entry.second.size)));
+            file->set("Modified", plist::Integer::New(static_cast<int64_t>(entry.second.modified)));
+            file->set("Contents", entry.second.contents->copy());
+            files->set(entry.first, std::move(file));
+        }
+    }
+
+    std::unique_ptr<plist::Dictionary> dict = plist::Dictionary::New();
+    dict->set("Version", plist::Integer::New(CacheVersion));
+    dict->set("Files", std::move(files));
+
+    auto serialized = plist::Format::Binary::Serialize(dict.get(), plist::Format::Binary::Create());
+    if (serialized.first == nullptr) {
+        fprintf(stderr, "warning: could not serialize specification cache: %s\n", serialized.second.c_str());
+        return false;
+    }
+
+    /* Other builds may be reading the cache, so never leave it partially written. */
+    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(*_cachePath), true) || !filesystem->writeAtomic(*serialized.first, *_cachePath)) {
+        fprintf(stderr, "warning: could not write specification cache '%s'\n", _cachePath->c_str());
+        return false;
+    }
+
+    _cacheChanged = false;
+    return true;
+}
+
 Manager::shared_ptr Manager::
 Create(void)
 {
@@ -578,6 +777,24 @@ PlatformDependentDomains(std::string const &developerRoot)
     return domains;
 }
 
+std::string Manager::
+CachePath(std::string const &cacheDirectory, std::string const &developerRoot)
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(developerRoot.data()), developerRoot.size());
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t c : digest) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+
+    return cacheDirectory + "/" + "Specifications-" + ss.str() + ".bplist";
+}
+
 std::vector<std::string> Manager::
 DeveloperBuildRules(std::string const &developerRoot)
 {
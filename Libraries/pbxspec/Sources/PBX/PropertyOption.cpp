@@ -55,7 +55,7 @@ ext::optional<pbxsetting::Setting> PropertyOption::
 defaultSetting(void) const
 {
     if (_defaultValue) {
-        return pbxsetting::Setting::Create(_name, *_defaultValue);
+        return pbxsetting::Setting::Create(_name.string(), *_defaultValue);
     } else {
         return ext::nullopt;
     }
@@ -107,7 +107,7 @@ parse(plist::Dictionary const *dict)
     }
 
     if (N != nullptr) {
-        _name = N->value();
+        _name = pbxsetting::Symbol(N->value());
     } else {
         /* Name is required. */
         return false;
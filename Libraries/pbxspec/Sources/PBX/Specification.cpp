@@ -199,24 +199,24 @@ Parse(Context *context, plist::Dictionary const *dict, ext::optional<Specificati
     abort();
 }
 
-ext::optional<Specification::vector> Specification::
-Open(Filesystem const *filesystem, Context *context, std::string const &filename, ext::optional<SpecificationType> defaultType)
+std::unique_ptr<plist::Object> Specification::
+Read(Filesystem const *filesystem, std::string const &filename)
 {
     if (filename.empty()) {
         fprintf(stderr, "error: empty specification path\n");
-        return ext::nullopt;
+        return nullptr;
     }
 
     std::string realPath = filesystem->resolvePath(filename);
     if (realPath.empty()) {
         fprintf(stderr, "error: invalid specification path\n");
-        return ext::nullopt;
+        return nullptr;
     }
 
     std::vector<uint8_t> contents;
     if (!filesystem->read(&contents, realPath)) {
         fprintf(stderr, "error: unable to read specification plist\n");
-        return ext::nullopt;
+        return nullptr;
     }
 
     //
@@ -225,21 +225,38 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
     std::unique_ptr<plist::Object> plist = plist::Format::Any::Deserialize(contents).first;
     if (plist == nullptr) {
         fprintf(stderr, "error: unable to parse specification plist\n");
+        return nullptr;
+    }
+
+    return plist;
+}
+
+ext::optional<Specification::vector> Specification::
+Open(Filesystem const *filesystem, Context *context, std::string const &filename, ext::optional<SpecificationType> defaultType)
+{
+    std::unique_ptr<plist::Object> plist = Read(filesystem, filename);
+    if (plist == nullptr) {
         return ext::nullopt;
     }
 
+    return Open(context, plist.get(), filename, defaultType);
+}
+
+ext::optional<Specification::vector> Specification::
+Open(Context *context, plist::Object const *plist, std::string const &filename, ext::optional<SpecificationType> defaultType)
+{
     //
     // If this is a dictionary, then it's a single specification,
     // if it's an array then multiple specifications are present.
     //
-    if (auto dict = plist::CastTo <plist::Dictionary> (plist.get())) {
+    if (auto dict = plist::CastTo <plist::Dictionary> (plist)) {
         if (auto spec = Parse(context, dict, defaultType)) {
             return Specification::vector({ spec });
         } else {
             fprintf(stderr, "error: single specification failed to parse\n");
             return ext::nullopt;
         }
-    } else if (auto array = plist::CastTo <plist::Array> (plist.get())) {
+    } else if (auto array = plist::CastTo <plist::Array> (plist)) {
         size_t errors = 0;
         Specification::vector specifications;
 
@@ -265,7 +282,7 @@ Open(Filesystem const *filesystem, Context *context, std::string const &filename
         }
     }
 
-    fprintf(stderr, "error: specification file '%s' does not contain a dictionary nor an array", filename.c_str());
+    fprintf(stderr, "error: specification file '%s' does not contain a dictionary nor an array\n", filename.c_str());
     return ext::nullopt;
 }
 
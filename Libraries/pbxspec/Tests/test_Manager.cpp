@@ -0,0 +1,210 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxspec/Manager.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxspec::Manager;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static std::vector<uint8_t>
+FileTypeSpecification(std::string const &identifier, std::string const &name)
+{
+    return Contents("{ Type = FileType; Identifier = \"" + identifier + "\"; Name = \"" + name + "\"; }");
+}
+
+TEST(Manager, Cache)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("specs", {
+            MemoryFilesystem::Entry::File("changed.xcspec", FileTypeSpecification("changed", "first")),
+            MemoryFilesystem::Entry::File("unchanged.xcspec", FileTypeSpecification("unchanged", "first")),
+        }),
+    });
+    std::string cachePath = filesystem.path("Caches/Specifications.bplist");
+
+    /* Without a cache, every file is parsed and saved. */
+    auto first = Manager::Create();
+    EXPECT_FALSE(first->loadCache(&filesystem, cachePath));
+    first->registerDomains(&filesystem, { { "domain", filesystem.path("specs") } });
+    ASSERT_NE(nullptr, first->fileType("changed", { "domain" }));
+    EXPECT_TRUE(first->saveCache(&filesystem));
+    EXPECT_TRUE(filesystem.exists(cachePath));
+
+    /*
+     * Change one file's contents without changing its size or modification
+     * time, and write the other. Only the written file is parsed again.
+     */
+    filesystem.root().child("specs")->child("unchanged.xcspec")->contents() = FileTypeSpecification("unchanged", "fresh");
+    ASSERT_TRUE(filesystem.write(FileTypeSpecification("changed", "second"), filesystem.path("specs/changed.xcspec")));
+
+    auto second = Manager::Create();
+    EXPECT_TRUE(second->loadCache(&filesystem, cachePath));
+    second->registerDomains(&filesystem, { { "domain", filesystem.path("specs") } });
+    ASSERT_NE(nullptr, second->fileType("changed", { "domain" }));
+    ASSERT_NE(nullptr, second->fileType("unchanged", { "domain" }));
+    EXPECT_EQ("second", *second->fileType("changed", { "domain" })->name());
+    EXPECT_EQ("first", *second->fileType("unchanged", { "domain" })->name());
+    EXPECT_TRUE(second->saveCache(&filesystem));
+
+    /* The saved cache has the newly parsed file. */
+    auto third = Manager::Create();
+    EXPECT_TRUE(third->loadCache(&filesystem, cachePath));
+    third->registerDomains(&filesystem, { { "domain", filesystem.path("specs") } });
+    ASSERT_NE(nullptr, third->fileType("changed", { "domain" }));
+    EXPECT_EQ("second", *third->fileType("changed", { "domain" })->name());
+}
+
+TEST(Manager, InvalidCache)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("specs", {
+            MemoryFilesystem::Entry::File("type.xcspec", FileTypeSpecification("type", "name")),
+        }),
+        MemoryFilesystem::Entry::File("cache.bplist", Contents("bplist00")),
+    });
+
+    /* A truncated cache is ignored, and files are parsed instead. */
+    auto manager = Manager::Create();
+    EXPECT_FALSE(manager->loadCache(&filesystem, filesystem.path("cache.bplist")));
+    manager->registerDomains(&filesystem, { { "domain", filesystem.path("specs") } });
+    ASSERT_NE(nullptr, manager->fileType("type", { "domain" }));
+    EXPECT_EQ("name", *manager->fileType("type", { "domain" })->name());
+}
+
+TEST(Manager, IdentifierLookup)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("first", {
+            MemoryFilesystem::Entry::File("types.xcspec", Contents(
+                "("
+                "{ Type = FileType; Identifier = shared; Name = first; },"
+                "{ Type = FileType; Identifier = duplicate; Name = registered; },"
+                "{ Type = FileType; Identifier = duplicate; Name = ignored; },"
+                "{ Type = Architecture; Identifier = shared; Name = architecture; },"
+                ")")),
+        }),
+        MemoryFilesystem::Entry::Directory("second", {
+            MemoryFilesystem::Entry::File("types.xcspec", FileTypeSpecification("shared", "second")),
+            MemoryFilesystem::Entry::File("only.xcspec", FileTypeSpecification("only", "second")),
+        }),
+    });
+
+    auto manager = Manager::Create();
+    manager->registerDomains(&filesystem, {
+        { "first", filesystem.path("first") },
+        { "second", filesystem.path("second") },
+    });
+
+    /* Earlier domains take precedence. */
+    ASSERT_NE(nullptr, manager->fileType("shared", { "first", "second" }));
+    EXPECT_EQ("first", *manager->fileType("shared", { "first", "second" })->name());
+    ASSERT_NE(nullptr, manager->fileType("shared", { "second", "first" }));
+    EXPECT_EQ("second", *manager->fileType("shared", { "second", "first" })->name());
+
+    /* Domains without the identifier, or not registered, are skipped. */
+    ASSERT_NE(nullptr, manager->fileType("only", { "first", "missing", "second" }));
+    EXPECT_EQ("second", *manager->fileType("only", { "first", "missing", "second" })->name());
+    EXPECT_EQ(nullptr, manager->fileType("only", { "first", "missing" }));
+    EXPECT_EQ(nullptr, manager->fileType("absent", { "first", "second" }));
+
+    /* Any domain finds the same specification as searching every specification. */
+    auto any = manager->fileType("shared", { Manager::AnyDomain() });
+    ASSERT_NE(nullptr, any);
+    for (auto const &fileType : manager->fileTypes({ Manager::AnyDomain() })) {
+        if (fileType->identifier() == "shared") {
+            EXPECT_EQ(fileType, any);
+            break;
+        }
+    }
+
+    /* Identifiers are separate for each type. */
+    ASSERT_NE(nullptr, manager->architecture("shared", { "first" }));
+    EXPECT_EQ("architecture", *manager->architecture("shared", { "first" })->name());
+    EXPECT_EQ(nullptr, manager->architecture("shared", { "second" }));
+
+    /* The first specification registered with an identifier in a domain wins. */
+    ASSERT_NE(nullptr, manager->fileType("duplicate", { "first" }));
+    EXPECT_EQ("registered", *manager->fileType("duplicate", { "first" })->name());
+    size_t duplicates = 0;
+    for (auto const &fileType : manager->fileTypes({ "first" })) {
+        duplicates += (fileType->identifier() == "duplicate");
+    }
+    EXPECT_EQ(1, duplicates);
+}
+
+/*
+ * The identifier, name, and dialect of each file type in a domain, in order.
+ */
+static std::vector<std::string>
+DescribeFileTypes(Manager::shared_ptr const &manager, std::string const &domain)
+{
+    std::vector<std::string> descriptions;
+    for (auto const &fileType : manager->fileTypes({ domain })) {
+        descriptions.push_back(fileType->identifier() + " " + fileType->name().value_or("") + " " + fileType->GCCDialectName().value_or(""));
+    }
+    return descriptions;
+}
+
+TEST(Manager, RegisterDomainsOrder)
+{
+    /* Many files in each domain, so they are parsed in parallel. Later domains inherit from earlier ones. */
+    std::vector<MemoryFilesystem::Entry> base;
+    std::vector<MemoryFilesystem::Entry> middle;
+    std::vector<MemoryFilesystem::Entry> top;
+    base.push_back(MemoryFilesystem::Entry::File("base.xcspec", Contents("{ Type = FileType; Identifier = base; Name = Base; GccDialectName = c; }")));
+    for (int n = 0; n < 32; n++) {
+        std::string number = std::to_string(n);
+        middle.push_back(MemoryFilesystem::Entry::File("middle" + number + ".xcspec", Contents(
+            "{ Type = FileType; Identifier = middle" + number + "; BasedOn = \"base:base\"; }")));
+        top.push_back(MemoryFilesystem::Entry::File("top" + number + ".xcspec", Contents(
+            "({ Type = FileType; Identifier = top" + number + "; BasedOn = \"middle:middle" + number + "\"; Name = Top; },"
+            " { Type = FileType; Identifier = derived" + number + "; BasedOn = top" + number + "; })")));
+    }
+
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("base", base),
+        MemoryFilesystem::Entry::Directory("middle", middle),
+        MemoryFilesystem::Entry::Directory("top", top),
+    });
+    std::vector<std::pair<std::string, std::string>> domains = {
+        { "base", filesystem.path("base") },
+        { "middle", filesystem.path("middle") },
+        { "top", filesystem.path("top") },
+    };
+
+    /* Registering one domain at a time loads the files serially. */
+    auto serial = Manager::Create();
+    for (auto const &domain : domains) {
+        serial->registerDomains(&filesystem, { domain });
+    }
+
+    EXPECT_EQ(32, DescribeFileTypes(serial, "middle").size());
+    EXPECT_EQ(64, DescribeFileTypes(serial, "top").size());
+    ASSERT_NE(nullptr, serial->fileType("derived7", { "top" }));
+    EXPECT_EQ("Top", *serial->fileType("derived7", { "top" })->name());
+    EXPECT_EQ("c", *serial->fileType("derived7", { "top" })->GCCDialectName());
+
+    /* Registering them together gives the same specifications, in the same order, every time. */
+    for (int attempt = 0; attempt < 8; attempt++) {
+        auto parallel = Manager::Create();
+        parallel->registerDomains(&filesystem, domains);
+
+        for (auto const &domain : domains) {
+            EXPECT_EQ(DescribeFileTypes(serial, domain.first), DescribeFileTypes(parallel, domain.first));
+        }
+    }
+}
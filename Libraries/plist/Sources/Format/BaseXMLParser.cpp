@@ -287,6 +287,12 @@ parse(std::vector<uint8_t> const &contents)
 
     return (ret == S_FALSE);
 #else
+    /* Initialize once before any parse, as parses can run on multiple threads. */
+    static std::once_flag initialize;
+    std::call_once(initialize, []{
+        ::xmlInitParser();
+    });
+
     _parser = ::xmlReaderForMemory(reinterpret_cast<char const *>(contents.data()), contents.size(), nullptr, nullptr, XML_PARSE_NOENT | XML_PARSE_NONET);
     if (_parser == nullptr) {
         return false;
@@ -25,7 +25,7 @@ public:
     ~DefaultLauncher();
 
 public:
-    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context);
+    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context, std::string *output = nullptr);
 };
 
 }
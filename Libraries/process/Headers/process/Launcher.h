@@ -10,6 +10,7 @@
 #ifndef __process_Launcher_h
 #define __process_Launcher_h
 
+#include <string>
 #include <ext/optional>
 
 namespace libutil { class Filesystem; }
@@ -30,8 +31,12 @@ public:
     /*
      * Launch and wait for a process. The filesystem is symbolic, to note
      * that launching a process could arbitrarily affect the filesystem.
+     *
+     * If `output` is provided, the process's output is collected into it
+     * rather than being written out, so concurrent processes don't mix
+     * their output together.
      */
-    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context) = 0;
+    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context, std::string *output = nullptr) = 0;
 };
 
 }
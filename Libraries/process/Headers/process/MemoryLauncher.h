@@ -37,7 +37,7 @@ public:
     ~MemoryLauncher();
 
 public:
-    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context);
+    virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context, std::string *output = nullptr);
 };
 
 }
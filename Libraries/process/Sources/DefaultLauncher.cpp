@@ -11,6 +11,8 @@
 #include <process/Context.h>
 #include <libutil/Filesystem.h>
 
+#include <mutex>
+
 #if _WIN32
 #include <windows.h>
 #else
@@ -104,7 +106,7 @@ DefaultLauncher::
 }
 
 ext::optional<int> DefaultLauncher::
-launch(Filesystem *filesystem, Context const *context)
+launch(Filesystem *filesystem, Context const *context, std::string *output)
 {
 #if _WIN32
     WideString executablePath = StringToWideString(context->executablePath());
@@ -198,12 +200,23 @@ launch(Filesystem *filesystem, Context const *context)
     execEnv.push_back(nullptr);
     char *const *cExecEnv = const_cast<char *const *>(execEnv.data());
 
+    /*
+     * Processes can be launched from multiple threads at once. Create the pipe
+     * and fork while holding a lock, and mark the pipe close-on-exec, so other
+     * children never inherit this pipe and hold it open after this child exits.
+     */
+    static std::mutex *forkMutex = new std::mutex();
+    std::unique_lock<std::mutex> forkLock(*forkMutex);
+
     /* Setup parent-child stdout/stderr pipe. */
     int pfd[2];
     bool pipe_setup_success = true;
     if (pipe(pfd) == -1) {
         ::perror("pipe");
         pipe_setup_success = false;
+    } else {
+        fcntl(pfd[0], F_SETFD, FD_CLOEXEC);
+        fcntl(pfd[1], F_SETFD, FD_CLOEXEC);
     }
 
     /*
@@ -212,6 +225,10 @@ launch(Filesystem *filesystem, Context const *context)
     pid_t pid = fork();
     if (pid < 0) {
         /* Fork failed. */
+        if (pipe_setup_success) {
+            close(pfd[0]);
+            close(pfd[1]);
+        }
         return ext::nullopt;
     } else if (pid == 0) {
         /* Fork succeeded, new process. */
@@ -246,12 +263,20 @@ launch(Filesystem *filesystem, Context const *context)
         /* Fork succeeded, existing process. */
         if (pipe_setup_success) {
             close(pfd[1]);
+        }
+        forkLock.unlock();
+
+        if (pipe_setup_success) {
             /* Read child's stdout/stderr through pipe, and output stdout */
             while (true) {
                 char pin[PIPE_BUFFER_SIZE];
                 int readlen = read(pfd[0], &pin, sizeof(pin));
                 if (readlen > 0) {
-                    fwrite(pin, readlen, 1, stdout);
+                    if (output != nullptr) {
+                        output->append(pin, readlen);
+                    } else {
+                        fwrite(pin, readlen, 1, stdout);
+                    }
                 } else {
                     if (readlen != 0) {
                         ::perror("read");
@@ -49,6 +49,8 @@ private:
     ext::optional<std::string> _formatter;
     ext::optional<std::string> _executor;
     ext::optional<bool>        _generate;
+    ext::optional<bool>        _digests;
+    ext::optional<std::string> _actionCache;
 
 private:
     ext::optional<bool>        _parallelizeTargets;
@@ -158,6 +160,12 @@ public:
     /* Extension. */
     bool generate() const
     { return _generate.value_or(false); }
+    /* Extension. */
+    bool digests() const
+    { return _digests.value_or(false); }
+    /* Extension. */
+    ext::optional<std::string> const &actionCache() const
+    { return _actionCache; }
 
 public:
     bool parallelizeTargets() const
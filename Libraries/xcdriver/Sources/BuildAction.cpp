@@ -17,6 +17,8 @@
 #include <builtin/Registry.h>
 #include <libutil/Base.h>
 #include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Parallel.h>
 #include <process/Context.h>
 
 #if !_WIN32
@@ -26,6 +28,7 @@
 using xcdriver::BuildAction;
 using xcdriver::Options;
 using libutil::Filesystem;
+using libutil::FSUtil;
 
 BuildAction::
 BuildAction()
@@ -64,11 +67,15 @@ CreateExecutor(
     ext::optional<std::string> const &executor,
     std::shared_ptr<xcformatter::Formatter> const &formatter,
     bool dryRun,
-    bool generate)
+    bool generate,
+    size_t jobs,
+    bool parallelizeTargets,
+    bool digests,
+    ext::optional<std::string> const &actionCache)
 {
     if (!executor || *executor == "simple") {
         auto registry = builtin::Registry::Default();
-        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry);
+        auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry, jobs, parallelizeTargets, digests, actionCache);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     } else if (*executor == "ninja") {
         auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate);
@@ -93,8 +100,17 @@ VerifySupportedOptions(Options const &options)
         fprintf(stderr, "warning: destination option not implemented\n");
     }
 
-    if (options.parallelizeTargets() || options.jobs()) {
-        fprintf(stderr, "warning: job control option not implemented\n");
+    if (options.jobs() && *options.jobs() < 1) {
+        fprintf(stderr, "error: invalid number of jobs %d\n", *options.jobs());
+        return false;
+    }
+
+    if ((options.jobs() || options.parallelizeTargets()) && options.executor() && *options.executor() == "ninja") {
+        fprintf(stderr, "warning: job control option not implemented for ninja executor\n");
+    }
+
+    if ((options.digests() || options.actionCache()) && options.executor() && *options.executor() == "ninja") {
+        fprintf(stderr, "warning: incremental build options not implemented for ninja executor\n");
     }
 
     if (options.enableAddressSanitizer() || options.enableThreadSanitizer() || options.enableCodeCoverage()) {
@@ -147,7 +163,12 @@ Run(process::User const *user, process::Context const *processContext, process::
     /*
      * Create the executor used to perform the build.
      */
-    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate());
+    size_t jobs = (options.jobs() ? static_cast<size_t>(*options.jobs()) : libutil::Parallel::DefaultWorkers());
+    ext::optional<std::string> actionCache;
+    if (options.actionCache()) {
+        actionCache = FSUtil::ResolveRelativePath(*options.actionCache(), processContext->currentDirectory());
+    }
+    std::unique_ptr<xcexecution::Executor> executor = CreateExecutor(options.executor(), formatter, options.dryRun(), options.generate(), jobs, options.parallelizeTargets(), options.digests(), actionCache);
     if (executor == nullptr) {
         fprintf(stderr, "error: unknown executor '%s'\n", options.executor()->c_str());
         return -1;
@@ -162,6 +183,9 @@ Run(process::User const *user, process::Context const *processContext, process::
         return -1;
     }
 
+    /* Keep any newly parsed specifications for the next build. */
+    buildEnvironment->specManager()->saveCache(filesystem);
+
     /* The build settings passed in on the command line override all others. */
     std::vector<pbxsetting::Level> overrideLevels = Action::CreateOverrideLevels(
         processContext,
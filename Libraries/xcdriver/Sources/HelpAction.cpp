@@ -72,6 +72,16 @@ Run(process::Context const *processContext)
         "    -generate                                   "
         "specify that an execution engine based on generating another build "
         "language should regenerate\n");
+    fprintf(
+        stdout,
+        "    -digests                                    "
+        "specify that the simple execution engine should compare file "
+        "contents, not only modification times, to skip up to date work\n");
+    fprintf(
+        stdout,
+        "    -actionCache PATH                           "
+        "specify that the simple execution engine should reuse outputs of "
+        "identical work from the cache directory PATH\n");
     fprintf(
         stdout,
         "    -project NAME                               "
@@ -26,6 +26,8 @@ Text(std::string const &name) {
         "[-formatter [default]] "
         "[-executor [simple|ninja]] "
         "[-generate] "
+        "[-digests] "
+        "[-actionCache <cachepath>] "
         "[<buildaction>]..." << std::endl;
 
     result << "       " << name << " "
@@ -39,6 +41,8 @@ Text(std::string const &name) {
         "[-formatter [default]] "
         "[-executor [simple|ninja]] "
         "[-generate] "
+        "[-digests] "
+        "[-actionCache <cachepath>] "
         "[<buildaction>]..." << std::endl;
 
     result << "       " << name << " "
@@ -52,6 +56,8 @@ Text(std::string const &name) {
         "[-formatter [default]] "
         "[-executor [simple|ninja]] "
         "[-generate] "
+        "[-digests] "
+        "[-actionCache <cachepath>] "
         "[<buildaction>]..." << std::endl;
 
     result << "       " << name << " -version "
@@ -0,0 +1,80 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_ActionCache_h
+#define __xcexecution_ActionCache_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+
+namespace xcexecution {
+
+class DigestCache;
+
+/*
+ * Local cache of the outputs of previously run invocations, stored in a
+ * directory that can be shared between builds and workspaces. Output file
+ * contents are stored once, by digest, under `blobs`.
+ *
+ * Invocations are looked up in two steps. The action key is a digest of the
+ * command and the contents of the declared inputs. It maps to a manifest, in
+ * `actions`, listing all of the inputs read the last time the action ran,
+ * including discovered dependencies. The digest of those inputs' contents
+ * then maps to the invocation's outputs, in `results`. Files in the cache
+ * are written to a temporary path and renamed into place, so concurrent or
+ * interrupted builds never leave partial entries. Input digests come
+ * from a digest cache, so inputs shared between actions are hashed once.
+ */
+class ActionCache {
+private:
+    std::string _path;
+
+public:
+    explicit ActionCache(std::string const &path);
+
+public:
+    /*
+     * The directory containing the cache.
+     */
+    std::string const &path() const
+    { return _path; }
+
+public:
+    /*
+     * The action key for a command and its declared inputs. Fails if an
+     * input exists but couldn't be read, such as for a directory.
+     */
+    static ext::optional<std::string>
+    ActionKey(libutil::Filesystem const *filesystem, DigestCache *digests, std::string const &command, std::vector<std::string> const &inputs);
+
+public:
+    /*
+     * Write the cached outputs for an action into place. Returns if the
+     * cached outputs are exactly the expected outputs, in order, and all of
+     * them were written.
+     */
+    bool restore(libutil::Filesystem *filesystem, DigestCache *digests, std::string const &action, std::vector<std::string> const &outputs) const;
+
+    /*
+     * Store the outputs of an action after it ran, along with all of the
+     * inputs it read. Fails if any of the outputs couldn't be read, or if
+     * any of the inputs was modified after the action `started`, as the
+     * filesystem's current time from before it ran.
+     */
+    bool store(libutil::Filesystem *filesystem, DigestCache *digests, std::string const &action, std::vector<std::string> const &inputs, std::vector<std::string> const &outputs, uint64_t started) const;
+};
+
+}
+
+#endif // !__xcexecution_ActionCache_h
@@ -0,0 +1,204 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_BuildDatabase_h
+#define __xcexecution_BuildDatabase_h
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+
+namespace xcexecution {
+
+class DigestCache;
+
+/*
+ * Persistent record of the invocations run by previous builds. For each
+ * invocation, stores a hash of its command and the state of its inputs
+ * (including discovered dependencies) and outputs after it last succeeded.
+ * An invocation is up to date if its command is unchanged and none of those
+ * files changed since.
+ *
+ * Optionally, also records a digest of each file's contents. Then a file
+ * whose modification time changed is still unchanged if its contents are
+ * the same, so regenerating an identical file, or resetting modification
+ * times in a fresh checkout, doesn't cause invocations to run again.
+ * Digests come from a cache shared with the rest of the build, so each
+ * file is hashed once even when many invocations read it.
+ *
+ * Safe to use from multiple threads at once.
+ */
+class BuildDatabase {
+public:
+    /*
+     * The recorded state of a file.
+     */
+    class File {
+    private:
+        std::string                _path;
+        bool                       _exists;
+        uint64_t                   _size;
+        uint64_t                   _modified;
+        ext::optional<std::string> _digest;
+
+    public:
+        File(std::string const &path, bool exists, uint64_t size, uint64_t modified, ext::optional<std::string> const &digest = ext::nullopt);
+
+    public:
+        /*
+         * The path to the file.
+         */
+        std::string const &path() const
+        { return _path; }
+
+        /*
+         * If the file existed. Missing inputs are recorded, so the
+         * invocation runs again when they are created.
+         */
+        bool exists() const
+        { return _exists; }
+
+        /*
+         * The size of the file.
+         */
+        uint64_t size() const
+        { return _size; }
+
+        /*
+         * When the file was last modified.
+         */
+        uint64_t modified() const
+        { return _modified; }
+
+        /*
+         * Digest of the file's contents, if recorded.
+         */
+        ext::optional<std::string> const &digest() const
+        { return _digest; }
+
+    public:
+        /*
+         * Read the current state of a file, including a digest of its
+         * contents if given a digest cache. Fails if the path exists but
+         * is not a regular file, as the state of a directory is unknown.
+         */
+        static ext::optional<File>
+        Read(libutil::Filesystem const *filesystem, std::string const &path, DigestCache *digests);
+    };
+
+    /*
+     * The record for an invocation.
+     */
+    class Entry {
+    private:
+        std::string       _command;
+        std::vector<File> _inputs;
+        std::vector<File> _outputs;
+
+    public:
+        Entry(std::string const &command, std::vector<File> const &inputs, std::vector<File> const &outputs);
+
+    public:
+        /*
+         * Hash of the command run by the invocation.
+         */
+        std::string const &command() const
+        { return _command; }
+
+        /*
+         * Inputs to the invocation, including discovered dependencies.
+         */
+        std::vector<File> const &inputs() const
+        { return _inputs; }
+
+        /*
+         * Outputs of the invocation.
+         */
+        std::vector<File> const &outputs() const
+        { return _outputs; }
+    };
+
+private:
+    DigestCache                           *_digests;
+    mutable std::mutex                     _mutex;
+    std::unordered_map<std::string, Entry> _entries;
+
+public:
+    /*
+     * Record file content digests, from the cache, if one is given.
+     */
+    explicit BuildDatabase(DigestCache *digests = nullptr);
+
+public:
+    /*
+     * If file content digests are recorded.
+     */
+    bool digests() const
+    { return _digests != nullptr; }
+
+public:
+    /*
+     * If an invocation with these outputs has already run the command, and
+     * its inputs and outputs have not changed since. When files are found
+     * unchanged by their digests, their new modification times are recorded
+     * so they aren't hashed again.
+     */
+    bool upToDate(libutil::Filesystem const *filesystem, std::vector<std::string> const &outputs, std::string const &command);
+
+    /*
+     * Read the current state of files, such as an invocation's declared
+     * inputs before it starts. Fails if a path exists but is not a regular
+     * file, or can't be stored.
+     */
+    ext::optional<std::vector<File>> read(libutil::Filesystem const *filesystem, std::vector<std::string> const &paths) const;
+
+    /*
+     * Record a successful invocation. The declared inputs should be read
+     * before the invocation started, so changes made while it ran are seen
+     * by the next build. Discovered inputs, from dependency info, are read
+     * now; if any was modified after `started`, the filesystem's current
+     * time from before the invocation ran, the outputs may not reflect it
+     * and nothing is recorded.
+     * Invocations with no outputs, or with outputs that aren't regular files,
+     * are not recorded either, and so are never up to date.
+     */
+    void record(
+        libutil::Filesystem const *filesystem,
+        std::vector<std::string> const &outputs,
+        std::string const &command,
+        std::vector<File> const &inputs,
+        std::vector<std::string> const &discovered,
+        uint64_t started);
+
+    /*
+     * Forget an invocation, so it runs again in the next build.
+     */
+    void remove(std::vector<std::string> const &outputs);
+
+public:
+    /*
+     * Load a database written by `save()`. A missing, outdated, or invalid
+     * database is treated as empty.
+     */
+    void load(libutil::Filesystem const *filesystem, std::string const &path);
+
+    /*
+     * Write the database to a path.
+     */
+    bool save(libutil::Filesystem *filesystem, std::string const &path) const;
+};
+
+}
+
+#endif // !__xcexecution_BuildDatabase_h
@@ -0,0 +1,147 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_BuildGraph_h
+#define __xcexecution_BuildGraph_h
+
+#include <pbxbuild/Tool/Invocation.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ext/optional>
+
+namespace xcexecution {
+
+/*
+ * The graph of jobs for a whole build, in the form run by the scheduler.
+ * Each target starts once the targets it depends on have finished. Within a
+ * target, the product structure is created before any other invocations run,
+ * and invocations keep their input and phase ordering. Invocations also wait
+ * for earlier targets producing their inputs.
+ *
+ * Every edge points to an earlier job, so with a single worker the build
+ * runs in the same order as building one target at a time.
+ */
+class BuildGraph {
+public:
+    /*
+     * One step of the build.
+     */
+    class Job {
+    public:
+        enum class Type {
+            /*
+             * Starts a target: writes its auxiliary files.
+             */
+            BeginTarget,
+            /*
+             * Runs an invocation.
+             */
+            Invocation,
+            /*
+             * Finishes creating a target's product structure.
+             */
+            FinishProductStructure,
+            /*
+             * Finishes a target, after all of its invocations.
+             */
+            FinishTarget,
+        };
+
+    private:
+        Type                              _type;
+        size_t                            _target;
+        pbxbuild::Tool::Invocation const *_invocation;
+        bool                              _createProductStructure;
+        std::vector<size_t>               _dependencies;
+
+    public:
+        Job(Type type, size_t target, pbxbuild::Tool::Invocation const *invocation, bool createProductStructure, std::vector<size_t> const &dependencies);
+
+    public:
+        Type type() const
+        { return _type; }
+
+        /*
+         * The target the job is part of, in the order targets were added.
+         */
+        size_t target() const
+        { return _target; }
+
+        /*
+         * The invocation to run, for invocation jobs.
+         */
+        pbxbuild::Tool::Invocation const *invocation() const
+        { return _invocation; }
+
+        /*
+         * If the invocation runs while creating the product structure.
+         */
+        bool createProductStructure() const
+        { return _createProductStructure; }
+
+        /*
+         * The jobs that must finish before this one starts.
+         */
+        std::vector<size_t> const &dependencies() const
+        { return _dependencies; }
+    };
+
+private:
+    std::vector<Job>                        _jobs;
+    std::vector<size_t>                     _targetFinishJobs;
+    std::unordered_map<std::string, size_t> _outputToJob;
+
+public:
+    BuildGraph();
+
+public:
+    /*
+     * The jobs added so far, in an order the scheduler can run them.
+     */
+    std::vector<Job> const &jobs() const
+    { return _jobs; }
+
+    /*
+     * The dependencies of each job, as the scheduler takes them.
+     */
+    std::vector<std::vector<size_t>>
+    dependencies() const;
+
+public:
+    /*
+     * Add the jobs for a target. The target starts after the `targets` it
+     * depends on, as indexes of previously added targets. The invocations
+     * must already be sorted in dependency order. Returns the target index.
+     */
+    size_t
+    addTarget(std::vector<size_t> const &targets, std::vector<pbxbuild::Tool::Invocation const *> const &orderedInvocations);
+
+public:
+    /*
+     * Determine the invocations each invocation depends on, as indexes into
+     * the invocations. An invocation depends on the invocations producing its
+     * inputs and on every invocation in the previous phase priority.
+     */
+    static std::vector<std::vector<size_t>>
+    InvocationDependencies(std::vector<pbxbuild::Tool::Invocation const *> const &invocations);
+
+    /*
+     * Sort a target's invocations so each comes after the invocations it
+     * depends on. The sorted invocations point into `invocations`, rather
+     * than copying them. Fails if the dependencies have a cycle.
+     */
+    static ext::optional<std::vector<pbxbuild::Tool::Invocation const *>>
+    SortInvocations(std::vector<pbxbuild::Tool::Invocation> const &invocations);
+};
+
+}
+
+#endif // !__xcexecution_BuildGraph_h
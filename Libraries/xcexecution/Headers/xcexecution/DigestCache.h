@@ -0,0 +1,55 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_DigestCache_h
+#define __xcexecution_DigestCache_h
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+
+namespace xcexecution {
+
+/*
+ * Digests of file contents computed during a build, so that files read by
+ * many invocations, such as SDK headers, are only hashed once. A digest is
+ * reused while the file's size and modification time are unchanged.
+ *
+ * Safe to use from multiple threads at once.
+ */
+class DigestCache {
+private:
+    struct Entry {
+        uint64_t    size;
+        uint64_t    modified;
+        std::string digest;
+    };
+
+private:
+    std::mutex                             _mutex;
+    std::unordered_map<std::string, Entry> _entries;
+
+public:
+    DigestCache();
+
+public:
+    /*
+     * The digest of a file's contents. Fails if the path is not a regular
+     * file or couldn't be read.
+     */
+    ext::optional<std::string> digest(libutil::Filesystem const *filesystem, std::string const &path);
+};
+
+}
+
+#endif // !__xcexecution_DigestCache_h
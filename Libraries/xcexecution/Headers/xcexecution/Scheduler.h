@@ -0,0 +1,54 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef __xcexecution_Scheduler_h
+#define __xcexecution_Scheduler_h
+
+#include <functional>
+#include <vector>
+
+namespace xcexecution {
+
+/*
+ * Runs a graph of dependent jobs across a number of workers. A job starts
+ * once every job it depends on has finished successfully. When more than
+ * one job is ready, the one with the lowest index runs first, so with a
+ * single worker and jobs in topological order, they run in that order.
+ */
+class Scheduler {
+public:
+    /*
+     * Runs one job. Returns if the job succeeded.
+     */
+    typedef std::function<bool(size_t job)> Job;
+
+private:
+    size_t _workers;
+
+public:
+    explicit Scheduler(size_t workers);
+
+public:
+    size_t workers() const
+    { return _workers; }
+
+public:
+    /*
+     * Runs the jobs `[0, dependencies.size())`, where `dependencies[n]` are
+     * the jobs that must finish before job `n` starts. The dependencies must
+     * not have cycles. After a job fails, no more jobs are started; the jobs
+     * already running are waited for. Returns the jobs that failed, if any.
+     */
+    std::vector<size_t>
+    run(std::vector<std::vector<size_t>> const &dependencies, Job const &job) const;
+};
+
+}
+
+#endif // !__xcexecution_Scheduler_h
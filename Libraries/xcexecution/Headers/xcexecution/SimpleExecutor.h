@@ -10,22 +10,41 @@
 #ifndef __xcexecution_SimpleExecutor_h
 #define __xcexecution_SimpleExecutor_h
 
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/DigestCache.h>
 #include <xcexecution/Executor.h>
+#include <xcexecution/Scheduler.h>
 #include <pbxbuild/Tool/AuxiliaryFile.h>
 #include <builtin/Registry.h>
 
+#include <mutex>
+
 namespace xcexecution {
 
+class BuildDatabase;
+
 /*
- * Simple executor that simply runs invocations in sequence. Advanced features
- * like incremental builds, dependency info, and such are not supported.
+ * Simple executor that runs the invocations for all targets as one dependency
+ * graph, using up to `jobs` concurrent invocations. Unless `parallelizeTargets`
+ * is set, each target waits for the previous target to finish. Invocations that
+ * are up to date with the last build, according to a build database stored with
+ * the intermediates, are skipped. With `digests`, the database also records
+ * file contents digests, so files with new modification times but the same
+ * contents don't cause invocations to run again. With an `actionCache` path,
+ * outputs of invocations that ran before with the same command and inputs,
+ * in any build using the same cache, are restored instead of running them.
  */
 class SimpleExecutor : public Executor {
 private:
-    builtin::Registry _builtins;
+    builtin::Registry          _builtins;
+    Scheduler                  _scheduler;
+    bool                       _parallelizeTargets;
+    bool                       _digests;
+    DigestCache                _digestCache;
+    ext::optional<ActionCache> _actionCache;
 
 public:
-    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs = 1, bool parallelizeTargets = false, bool digests = false, ext::optional<std::string> const &actionCache = ext::nullopt);
     ~SimpleExecutor();
 
 public:
@@ -41,25 +60,19 @@ public:
     bool writeAuxiliaryFiles(
         libutil::Filesystem *filesystem,
         std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles);
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> performInvocations(
+    bool performInvocation(
         process::Context const *processContext,
         process::Launcher *processLauncher,
         libutil::Filesystem *filesystem,
         std::vector<std::string> const &executablePaths,
-        std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-        bool createProductStructure);
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> buildTarget(
-        process::Context const *processContext,
-        process::Launcher *processLauncher,
-        libutil::Filesystem *filesystem,
-        pbxproj::PBX::Target::shared_ptr const &target,
-        pbxbuild::Target::Environment const &targetEnvironment,
-        std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
-        std::vector<pbxbuild::Tool::Invocation> const &invocations);
+        pbxbuild::Tool::Invocation const &invocation,
+        bool createProductStructure,
+        std::mutex *outputMutex,
+        BuildDatabase *database);
 
 public:
     static std::unique_ptr<SimpleExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs = 1, bool parallelizeTargets = false, bool digests = false, ext::optional<std::string> const &actionCache = ext::nullopt);
 };
 
 }
@@ -0,0 +1,231 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/DigestCache.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Permissions.h>
+#include <libutil/Digest.h>
+
+#include <sstream>
+
+using xcexecution::ActionCache;
+using xcexecution::DigestCache;
+using libutil::Digest;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::Permissions;
+
+/*
+ * Describe the contents of the inputs, one per line. Missing inputs are
+ * included as missing, so creating them changes the description.
+ */
+static ext::optional<std::string>
+DescribeInputs(Filesystem const *filesystem, DigestCache *digests, std::vector<std::string> const &inputs)
+{
+    std::string description;
+
+    for (std::string const &input : inputs) {
+        if (input.find('\n') != std::string::npos) {
+            return ext::nullopt;
+        }
+
+        if (!filesystem->exists(input)) {
+            description += "- " + input + "\n";
+        } else if (ext::optional<std::string> digest = digests->digest(filesystem, input)) {
+            description += *digest + " " + input + "\n";
+        } else {
+            return ext::nullopt;
+        }
+    }
+
+    return description;
+}
+
+static bool
+ReadLines(Filesystem const *filesystem, std::string const &path, std::vector<std::string> *lines)
+{
+    std::vector<uint8_t> contents;
+    if (filesystem->type(path) != Filesystem::Type::File || !filesystem->read(&contents, path)) {
+        return false;
+    }
+
+    std::istringstream stream(std::string(contents.begin(), contents.end()));
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines->push_back(line);
+    }
+
+    return true;
+}
+
+/*
+ * Write a file in the cache so that it appears with all of its contents or
+ * not at all, even if writing is interrupted or another build writes the
+ * same file at the same time.
+ */
+static bool
+WriteFile(Filesystem *filesystem, std::string const &path, std::vector<uint8_t> const &contents)
+{
+    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(path), true)) {
+        return false;
+    }
+
+    return filesystem->writeAtomic(contents, path);
+}
+
+/*
+ * A stored output, from a line in a result: `<digest> <executable> <path>`.
+ */
+struct Result {
+    std::string digest;
+    bool        executable;
+    std::string path;
+};
+
+static bool
+ParseResult(std::string const &line, Result *result)
+{
+    std::string::size_type digestEnd = line.find(' ');
+    if (digestEnd == std::string::npos || line.size() < digestEnd + 3 || line[digestEnd + 2] != ' ') {
+        return false;
+    }
+
+    result->digest = line.substr(0, digestEnd);
+    result->executable = (line[digestEnd + 1] == 'x');
+    result->path = line.substr(digestEnd + 3);
+    return true;
+}
+
+ActionCache::
+ActionCache(std::string const &path) :
+    _path(path)
+{
+}
+
+ext::optional<std::string> ActionCache::
+ActionKey(Filesystem const *filesystem, DigestCache *digests, std::string const &command, std::vector<std::string> const &inputs)
+{
+    ext::optional<std::string> description = DescribeInputs(filesystem, digests, inputs);
+    if (!description) {
+        return ext::nullopt;
+    }
+
+    return Digest::Hex(command + "\n" + *description);
+}
+
+bool ActionCache::
+restore(Filesystem *filesystem, DigestCache *digests, std::string const &action, std::vector<std::string> const &outputs) const
+{
+    /* Find the inputs read the last time the action ran. */
+    std::vector<std::string> inputs;
+    if (!ReadLines(filesystem, _path + "/actions/" + action, &inputs)) {
+        return false;
+    }
+
+    ext::optional<std::string> description = DescribeInputs(filesystem, digests, inputs);
+    if (!description) {
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    if (!ReadLines(filesystem, _path + "/results/" + Digest::Hex(action + "\n" + *description), &lines)) {
+        return false;
+    }
+
+    /* Only restore if the result has exactly the expected outputs. */
+    if (lines.size() != outputs.size()) {
+        return false;
+    }
+
+    std::vector<Result> results = std::vector<Result>(lines.size());
+    for (size_t n = 0; n < lines.size(); n++) {
+        if (!ParseResult(lines[n], &results[n]) || results[n].path != outputs[n]) {
+            return false;
+        }
+    }
+
+    for (Result const &result : results) {
+        /* Verify the contents, in case the blob was changed since. */
+        std::string blob = _path + "/blobs/" + result.digest;
+        std::vector<uint8_t> contents;
+        if (filesystem->type(blob) != Filesystem::Type::File || !filesystem->read(&contents, blob) || Digest::Hex(contents) != result.digest) {
+            return false;
+        }
+
+        if (!WriteFile(filesystem, result.path, contents)) {
+            return false;
+        }
+
+        if (result.executable) {
+            Permissions permissions = Permissions(
+                { Permissions::Permission::Read, Permissions::Permission::Write, Permissions::Permission::Execute },
+                { Permissions::Permission::Read, Permissions::Permission::Execute },
+                { Permissions::Permission::Read, Permissions::Permission::Execute });
+            if (!filesystem->writeFilePermissions(result.path, Permissions::Operation::Set, permissions)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ActionCache::
+store(Filesystem *filesystem, DigestCache *digests, std::string const &action, std::vector<std::string> const &inputs, std::vector<std::string> const &outputs, uint64_t started) const
+{
+    ext::optional<std::string> description = DescribeInputs(filesystem, digests, inputs);
+    if (!description) {
+        return false;
+    }
+
+    /*
+     * An input changed while the action ran, so the outputs may not match the
+     * described inputs. Checked after describing, so changes made while reading
+     * the inputs are also found.
+     */
+    for (std::string const &input : inputs) {
+        uint64_t size;
+        uint64_t modified;
+        if (filesystem->readFileInfo(input, &size, &modified) && modified >= started) {
+            return false;
+        }
+    }
+
+    /*
+     * Store the output contents first, so results never refer to missing blobs.
+     * Blobs are written atomically, so existing ones are complete.
+     */
+    std::string results;
+    for (std::string const &output : outputs) {
+        std::vector<uint8_t> contents;
+        if (output.find('\n') != std::string::npos || filesystem->type(output) != Filesystem::Type::File || !filesystem->read(&contents, output)) {
+            return false;
+        }
+
+        std::string digest = Digest::Hex(contents);
+        std::string blob = _path + "/blobs/" + digest;
+        if (!filesystem->exists(blob) && !WriteFile(filesystem, blob, contents)) {
+            return false;
+        }
+
+        results += digest + " " + (filesystem->isExecutable(output) ? "x" : "-") + " " + output + "\n";
+    }
+
+    if (!WriteFile(filesystem, _path + "/results/" + Digest::Hex(action + "\n" + *description), std::vector<uint8_t>(results.begin(), results.end()))) {
+        return false;
+    }
+
+    std::string manifest;
+    for (std::string const &input : inputs) {
+        manifest += input + "\n";
+    }
+    return WriteFile(filesystem, _path + "/actions/" + action, std::vector<uint8_t>(manifest.begin(), manifest.end()));
+}
@@ -0,0 +1,343 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/BuildDatabase.h>
+#include <xcexecution/DigestCache.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+using xcexecution::BuildDatabase;
+using xcexecution::DigestCache;
+using libutil::Filesystem;
+using libutil::FSUtil;
+
+/*
+ * Identifies the database format. Databases from other versions are ignored.
+ */
+static std::string const DatabaseHeader = "xcbuild-database 2";
+
+BuildDatabase::File::
+File(std::string const &path, bool exists, uint64_t size, uint64_t modified, ext::optional<std::string> const &digest) :
+    _path    (path),
+    _exists  (exists),
+    _size    (size),
+    _modified(modified),
+    _digest  (digest)
+{
+}
+
+ext::optional<BuildDatabase::File> BuildDatabase::File::
+Read(Filesystem const *filesystem, std::string const &path, DigestCache *digests)
+{
+    uint64_t size;
+    uint64_t modified;
+    if (filesystem->readFileInfo(path, &size, &modified)) {
+        if (digests == nullptr) {
+            return File(path, true, size, modified);
+        }
+
+        ext::optional<std::string> contentsDigest = digests->digest(filesystem, path);
+        if (!contentsDigest) {
+            return ext::nullopt;
+        }
+        return File(path, true, size, modified, contentsDigest);
+    } else if (!filesystem->exists(path)) {
+        return File(path, false, 0, 0);
+    } else {
+        return ext::nullopt;
+    }
+}
+
+BuildDatabase::Entry::
+Entry(std::string const &command, std::vector<File> const &inputs, std::vector<File> const &outputs) :
+    _command(command),
+    _inputs (inputs),
+    _outputs(outputs)
+{
+}
+
+BuildDatabase::
+BuildDatabase(DigestCache *digests) :
+    _digests(digests)
+{
+}
+
+static std::string
+EntryKey(std::vector<std::string> const &outputs)
+{
+    std::string key;
+    for (std::string const &output : outputs) {
+        key += output;
+        key += '\n';
+    }
+    return key;
+}
+
+/*
+ * Check if the files are unchanged. Files found unchanged by comparing their
+ * digests are updated with their current modification time.
+ */
+static bool
+FilesUnchanged(Filesystem const *filesystem, DigestCache *digests, std::vector<BuildDatabase::File> *files, bool *refreshed)
+{
+    for (BuildDatabase::File &file : *files) {
+        ext::optional<BuildDatabase::File> current = BuildDatabase::File::Read(filesystem, file.path(), nullptr);
+        if (!current || current->exists() != file.exists() || current->size() != file.size()) {
+            return false;
+        }
+
+        if (current->modified() != file.modified()) {
+            if (digests == nullptr || !file.digest() || digests->digest(filesystem, file.path()) != file.digest()) {
+                return false;
+            }
+
+            /* Contents are the same, so it's unchanged. */
+            file = BuildDatabase::File(file.path(), true, current->size(), current->modified(), file.digest());
+            *refreshed = true;
+        }
+    }
+
+    return true;
+}
+
+bool BuildDatabase::
+upToDate(Filesystem const *filesystem, std::vector<std::string> const &outputs, std::string const &command)
+{
+    if (outputs.empty()) {
+        return false;
+    }
+
+    ext::optional<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(EntryKey(outputs));
+        if (it == _entries.end()) {
+            return false;
+        }
+        entry = it->second;
+    }
+
+    if (entry->command() != command) {
+        return false;
+    }
+
+    /* Missing outputs are never up to date, even if they were missing before. */
+    for (File const &output : entry->outputs()) {
+        if (!output.exists()) {
+            return false;
+        }
+    }
+
+    std::vector<File> inputs = entry->inputs();
+    std::vector<File> outputFiles = entry->outputs();
+    bool refreshed = false;
+    if (!FilesUnchanged(filesystem, _digests, &inputs, &refreshed) || !FilesUnchanged(filesystem, _digests, &outputFiles, &refreshed)) {
+        return false;
+    }
+
+    if (refreshed) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.erase(EntryKey(outputs));
+        _entries.insert({ EntryKey(outputs), Entry(command, inputs, outputFiles) });
+    }
+
+    return true;
+}
+
+ext::optional<std::vector<BuildDatabase::File>> BuildDatabase::
+read(Filesystem const *filesystem, std::vector<std::string> const &paths) const
+{
+    std::vector<File> files;
+
+    for (std::string const &path : paths) {
+        /* Paths are stored one per line. */
+        if (path.find('\n') != std::string::npos) {
+            return ext::nullopt;
+        }
+
+        ext::optional<File> file = File::Read(filesystem, path, _digests);
+        if (!file) {
+            return ext::nullopt;
+        }
+
+        files.push_back(*file);
+    }
+
+    return files;
+}
+
+void BuildDatabase::
+record(
+    Filesystem const *filesystem,
+    std::vector<std::string> const &outputs,
+    std::string const &command,
+    std::vector<File> const &inputs,
+    std::vector<std::string> const &discovered,
+    uint64_t started)
+{
+    if (outputs.empty()) {
+        return;
+    }
+
+    ext::optional<std::vector<File>> discoveredFiles = read(filesystem, discovered);
+    ext::optional<std::vector<File>> outputFiles = read(filesystem, outputs);
+    if (!discoveredFiles || !outputFiles) {
+        remove(outputs);
+        return;
+    }
+
+    std::vector<File> inputFiles = inputs;
+    for (File const &file : *discoveredFiles) {
+        /* Changed while the invocation ran, so the outputs may be stale. */
+        if (file.exists() && file.modified() >= started) {
+            remove(outputs);
+            return;
+        }
+
+        inputFiles.push_back(file);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(EntryKey(outputs));
+    _entries.insert({ EntryKey(outputs), Entry(command, inputFiles, *outputFiles) });
+}
+
+void BuildDatabase::
+remove(std::vector<std::string> const &outputs)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(EntryKey(outputs));
+}
+
+static bool
+ParseFile(std::string const &line, size_t offset, std::vector<BuildDatabase::File> *files)
+{
+    /* Format is: `<size> <modified> <digest> <path>`, with `-` for missing values. */
+    std::istringstream stream(line.substr(offset));
+
+    std::string size;
+    std::string modified;
+    std::string digest;
+    if (!(stream >> size >> modified >> digest) || stream.get() != ' ') {
+        return false;
+    }
+
+    std::string path;
+    std::getline(stream, path);
+    if (path.empty()) {
+        return false;
+    }
+
+    if (size == "-" && modified == "-") {
+        files->push_back(BuildDatabase::File(path, false, 0, 0));
+    } else {
+        ext::optional<std::string> fileDigest = (digest != "-" ? ext::optional<std::string>(digest) : ext::nullopt);
+        files->push_back(BuildDatabase::File(path, true, std::strtoull(size.c_str(), nullptr, 10), std::strtoull(modified.c_str(), nullptr, 10), fileDigest));
+    }
+    return true;
+}
+
+void BuildDatabase::
+load(Filesystem const *filesystem, std::string const &path)
+{
+    std::vector<uint8_t> contents;
+    if (!filesystem->exists(path) || !filesystem->read(&contents, path)) {
+        return;
+    }
+
+    std::unordered_map<std::string, Entry> entries;
+
+    std::istringstream stream(std::string(contents.begin(), contents.end()));
+    std::string line;
+    if (!std::getline(stream, line) || line != DatabaseHeader) {
+        return;
+    }
+
+    ext::optional<std::string> command;
+    std::vector<File> inputs;
+    std::vector<File> outputs;
+    auto finishEntry = [&]() {
+        if (command && !outputs.empty()) {
+            std::vector<std::string> paths;
+            for (File const &output : outputs) {
+                paths.push_back(output.path());
+            }
+            entries.insert({ EntryKey(paths), Entry(*command, inputs, outputs) });
+        }
+
+        command = ext::nullopt;
+        inputs.clear();
+        outputs.clear();
+    };
+
+    while (std::getline(stream, line)) {
+        if (line.compare(0, 8, "command ") == 0) {
+            finishEntry();
+            command = line.substr(8);
+        } else if (command && line.compare(0, 6, "input ") == 0) {
+            if (!ParseFile(line, 6, &inputs)) {
+                fprintf(stderr, "warning: ignoring invalid build database %s\n", path.c_str());
+                return;
+            }
+        } else if (command && line.compare(0, 7, "output ") == 0) {
+            if (!ParseFile(line, 7, &outputs)) {
+                fprintf(stderr, "warning: ignoring invalid build database %s\n", path.c_str());
+                return;
+            }
+        } else {
+            fprintf(stderr, "warning: ignoring invalid build database %s\n", path.c_str());
+            return;
+        }
+    }
+    finishEntry();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries = std::move(entries);
+}
+
+static void
+SerializeFiles(std::ostringstream *stream, char const *type, std::vector<BuildDatabase::File> const &files)
+{
+    for (BuildDatabase::File const &file : files) {
+        *stream << type << ' ';
+        if (file.exists()) {
+            *stream << file.size() << ' ' << file.modified() << ' ' << file.digest().value_or("-");
+        } else {
+            *stream << "- - -";
+        }
+        *stream << ' ' << file.path() << '\n';
+    }
+}
+
+bool BuildDatabase::
+save(Filesystem *filesystem, std::string const &path) const
+{
+    std::ostringstream stream;
+    stream << DatabaseHeader << '\n';
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto const &entry : _entries) {
+            stream << "command " << entry.second.command() << '\n';
+            SerializeFiles(&stream, "input", entry.second.inputs());
+            SerializeFiles(&stream, "output", entry.second.outputs());
+        }
+    }
+
+    if (!filesystem->createDirectory(FSUtil::GetDirectoryName(path), true)) {
+        return false;
+    }
+
+    std::string contents = stream.str();
+    return filesystem->writeAtomic(std::vector<uint8_t>(contents.begin(), contents.end()), path);
+}
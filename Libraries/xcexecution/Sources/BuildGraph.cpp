@@ -0,0 +1,177 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/BuildGraph.h>
+#include <pbxbuild/DirectedGraph.h>
+
+#include <map>
+#include <unordered_set>
+
+using xcexecution::BuildGraph;
+
+BuildGraph::Job::
+Job(Type type, size_t target, pbxbuild::Tool::Invocation const *invocation, bool createProductStructure, std::vector<size_t> const &dependencies) :
+    _type                  (type),
+    _target                (target),
+    _invocation            (invocation),
+    _createProductStructure(createProductStructure),
+    _dependencies          (dependencies)
+{
+}
+
+BuildGraph::
+BuildGraph()
+{
+}
+
+std::vector<std::vector<size_t>> BuildGraph::
+dependencies() const
+{
+    std::vector<std::vector<size_t>> dependencies;
+    dependencies.reserve(_jobs.size());
+    for (Job const &job : _jobs) {
+        dependencies.push_back(job.dependencies());
+    }
+    return dependencies;
+}
+
+size_t BuildGraph::
+addTarget(std::vector<size_t> const &targets, std::vector<pbxbuild::Tool::Invocation const *> const &orderedInvocations)
+{
+    size_t target = _targetFinishJobs.size();
+
+    std::vector<size_t> startDependencies;
+    for (size_t dependency : targets) {
+        startDependencies.push_back(_targetFinishJobs.at(dependency));
+    }
+
+    size_t startJob = _jobs.size();
+    _jobs.push_back(Job(Job::Type::BeginTarget, target, nullptr, false, startDependencies));
+
+    /* Add the invocations for each pass, keeping the dependencies within each pass. */
+    std::vector<std::vector<size_t>> invocationDependencies = InvocationDependencies(orderedInvocations);
+    std::vector<size_t> invocationJobs = std::vector<size_t>(orderedInvocations.size());
+
+    /* Finishing the product structure waits for the start even without any invocations. */
+    size_t structureJob = startJob;
+    std::vector<size_t> finishDependencies = { startJob };
+    for (bool createProductStructure : { true, false }) {
+        for (size_t n = 0; n < orderedInvocations.size(); n++) {
+            pbxbuild::Tool::Invocation const *invocation = orderedInvocations[n];
+            if (invocation->createsProductStructure() != createProductStructure) {
+                continue;
+            }
+
+            std::vector<size_t> jobDependencies = { createProductStructure ? startJob : structureJob };
+            for (size_t dependency : invocationDependencies[n]) {
+                if (orderedInvocations[dependency]->createsProductStructure() == createProductStructure) {
+                    jobDependencies.push_back(invocationJobs[dependency]);
+                }
+            }
+            for (std::vector<std::string> const *paths : { &invocation->inputs(), &invocation->phonyInputs(), &invocation->inputDependencies() }) {
+                for (std::string const &path : *paths) {
+                    auto it = _outputToJob.find(path);
+                    if (it != _outputToJob.end()) {
+                        jobDependencies.push_back(it->second);
+                    }
+                }
+            }
+
+            invocationJobs[n] = _jobs.size();
+            _jobs.push_back(Job(Job::Type::Invocation, target, invocation, createProductStructure, jobDependencies));
+
+            if (createProductStructure) {
+                finishDependencies.push_back(invocationJobs[n]);
+            }
+        }
+
+        if (createProductStructure) {
+            structureJob = _jobs.size();
+            _jobs.push_back(Job(Job::Type::FinishProductStructure, target, nullptr, false, finishDependencies));
+            finishDependencies = { structureJob };
+        }
+    }
+
+    for (size_t n = 0; n < orderedInvocations.size(); n++) {
+        if (!orderedInvocations[n]->createsProductStructure()) {
+            finishDependencies.push_back(invocationJobs[n]);
+        }
+    }
+
+    _targetFinishJobs.push_back(_jobs.size());
+    _jobs.push_back(Job(Job::Type::FinishTarget, target, nullptr, false, finishDependencies));
+
+    /* Later targets wait for the invocations producing their inputs. */
+    for (size_t n = 0; n < orderedInvocations.size(); n++) {
+        for (std::string const &output : orderedInvocations[n]->outputs()) {
+            _outputToJob.insert({ output, invocationJobs[n] });
+        }
+    }
+
+    return target;
+}
+
+std::vector<std::vector<size_t>> BuildGraph::
+InvocationDependencies(std::vector<pbxbuild::Tool::Invocation const *> const &invocations)
+{
+    std::unordered_map<std::string, size_t> outputToInvocation;
+    std::map<uint32_t, std::vector<size_t>> priorityToInvocations;
+    for (size_t n = 0; n < invocations.size(); n++) {
+        for (std::string const &output : invocations[n]->outputs()) {
+            outputToInvocation.insert({ output, n });
+        }
+        priorityToInvocations[invocations[n]->priority()].push_back(n);
+    }
+
+    std::vector<std::vector<size_t>> dependencies = std::vector<std::vector<size_t>>(invocations.size());
+    for (size_t n = 0; n < invocations.size(); n++) {
+        pbxbuild::Tool::Invocation const *invocation = invocations[n];
+
+        for (std::vector<std::string> const *paths : { &invocation->inputs(), &invocation->phonyInputs(), &invocation->inputDependencies() }) {
+            for (std::string const &path : *paths) {
+                auto it = outputToInvocation.find(path);
+                if (it != outputToInvocation.end() && it->second != n) {
+                    dependencies[n].push_back(it->second);
+                }
+            }
+        }
+
+        /* Invocations in the next phase priority depend on this one. */
+        auto it = priorityToInvocations.find(invocation->priority());
+        if (it != priorityToInvocations.end() && std::next(it) != priorityToInvocations.end()) {
+            for (size_t other : std::next(it)->second) {
+                dependencies[other].push_back(n);
+            }
+        }
+    }
+
+    return dependencies;
+}
+
+ext::optional<std::vector<pbxbuild::Tool::Invocation const *>> BuildGraph::
+SortInvocations(std::vector<pbxbuild::Tool::Invocation> const &invocations)
+{
+    std::vector<pbxbuild::Tool::Invocation const *> pointers;
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        pointers.push_back(&invocation);
+    }
+
+    std::vector<std::vector<size_t>> dependencies = InvocationDependencies(pointers);
+
+    pbxbuild::DirectedGraph<pbxbuild::Tool::Invocation const *> graph;
+    for (size_t n = 0; n < pointers.size(); n++) {
+        std::unordered_set<pbxbuild::Tool::Invocation const *> edges;
+        for (size_t dependency : dependencies[n]) {
+            edges.insert(pointers[dependency]);
+        }
+        graph.insert(pointers[n], edges);
+    }
+
+    return graph.ordered();
+}
@@ -0,0 +1,55 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/DigestCache.h>
+#include <libutil/Digest.h>
+#include <libutil/Filesystem.h>
+
+using xcexecution::DigestCache;
+using libutil::Digest;
+using libutil::Filesystem;
+
+DigestCache::
+DigestCache()
+{
+}
+
+ext::optional<std::string> DigestCache::
+digest(Filesystem const *filesystem, std::string const &path)
+{
+    uint64_t size;
+    uint64_t modified;
+    if (!filesystem->readFileInfo(path, &size, &modified)) {
+        return ext::nullopt;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(path);
+        if (it != _entries.end() && it->second.size == size && it->second.modified == modified) {
+            return it->second.digest;
+        }
+    }
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path)) {
+        return ext::nullopt;
+    }
+    std::string digest = Digest::Hex(contents);
+
+    /* Only remember the digest if the file didn't change while reading it. */
+    uint64_t readSize;
+    uint64_t readModified;
+    if (filesystem->readFileInfo(path, &readSize, &readModified) && readSize == size && readModified == modified) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[path] = Entry { size, modified, digest };
+    }
+
+    return digest;
+}
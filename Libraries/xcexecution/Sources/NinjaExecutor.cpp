@@ -559,6 +559,13 @@ buildAction(
      */
     writer.rule(NinjaRuleName(), ninja::Value::Expression("cd $dir && env $env $exec && $depexec"));
 
+    /*
+     * Create all of the target environments up front; independent targets can be
+     * resolved in parallel, and the loop below then only looks them up.
+     */
+    std::vector<pbxproj::PBX::Target::shared_ptr> targets = std::vector<pbxproj::PBX::Target::shared_ptr>(targetGraph.nodes().begin(), targetGraph.nodes().end());
+    buildContext.createTargetEnvironments(buildEnvironment, targets);
+
     /*
      * Go over each target and write out Ninja targets for the start and end of each.
      * Don't bother topologically sorting the targets now, since Ninja will do that for us.
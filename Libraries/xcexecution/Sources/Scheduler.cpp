@@ -0,0 +1,111 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <xcexecution/Scheduler.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+using xcexecution::Scheduler;
+
+Scheduler::
+Scheduler(size_t workers) :
+    _workers(std::max<size_t>(workers, 1))
+{
+}
+
+std::vector<size_t> Scheduler::
+run(std::vector<std::vector<size_t>> const &dependencies, Job const &job) const
+{
+    size_t count = dependencies.size();
+
+    /* Count the unfinished dependencies of each job, and invert the edges. */
+    std::vector<size_t> waiting = std::vector<size_t>(count, 0);
+    std::vector<std::vector<size_t>> dependents = std::vector<std::vector<size_t>>(count);
+    for (size_t n = 0; n < count; n++) {
+        waiting[n] = dependencies[n].size();
+        for (size_t dependency : dependencies[n]) {
+            dependents[dependency].push_back(n);
+        }
+    }
+
+    /* Ready jobs, lowest index first. */
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+    for (size_t n = 0; n < count; n++) {
+        if (waiting[n] == 0) {
+            ready.push(n);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t running = 0;
+    std::vector<size_t> failed;
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            /* Wait for a job to become ready, or for the work to be finished. */
+            condition.wait(lock, [&]{
+                return (!ready.empty() && failed.empty()) || running == 0;
+            });
+
+            if (ready.empty() || !failed.empty()) {
+                /* Nothing is running and nothing more can start. */
+                condition.notify_all();
+                return;
+            }
+
+            size_t next = ready.top();
+            ready.pop();
+            running++;
+
+            lock.unlock();
+            bool success = job(next);
+            lock.lock();
+
+            running--;
+            if (success) {
+                for (size_t dependent : dependents[next]) {
+                    if (--waiting[dependent] == 0) {
+                        ready.push(dependent);
+                    }
+                }
+            } else {
+                failed.push_back(next);
+            }
+
+            condition.notify_all();
+        }
+    };
+
+    size_t workers = std::min(_workers, count);
+    if (workers <= 1) {
+        /* Run on the calling thread. */
+        if (count > 0) {
+            worker();
+        }
+    } else {
+        std::vector<std::thread> threads;
+        for (size_t n = 0; n < workers; n++) {
+            threads.emplace_back(worker);
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::sort(failed.begin(), failed.end());
+    return failed;
+}
@@ -9,12 +9,20 @@
 
 #include <xcexecution/SimpleExecutor.h>
 
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/BuildDatabase.h>
+#include <xcexecution/BuildGraph.h>
 #include <xcexecution/Parameters.h>
 #include <builtin/Driver.h>
+#include <dependency/BinaryDependencyInfo.h>
+#include <dependency/DependencyInfo.h>
+#include <dependency/DirectoryDependencyInfo.h>
+#include <dependency/MakefileDependencyInfo.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/Digest.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <process/Launcher.h>
@@ -23,19 +31,30 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
-#include <set>
+#include <functional>
+#include <map>
+#include <mutex>
 
 using xcexecution::SimpleExecutor;
+using xcexecution::ActionCache;
+using xcexecution::BuildGraph;
 using xcexecution::Parameters;
+using libutil::Digest;
 using libutil::Filesystem;
 using libutil::FSUtil;
 using libutil::Permissions;
 
 SimpleExecutor::
-SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins) :
-    Executor (formatter, dryRun, false),
-    _builtins(builtins)
+SimpleExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, bool digests, ext::optional<std::string> const &actionCache) :
+    Executor           (formatter, dryRun, false),
+    _builtins          (builtins),
+    _scheduler         (jobs),
+    _parallelizeTargets(parallelizeTargets),
+    _digests           (digests)
 {
+    if (actionCache) {
+        _actionCache = ActionCache(*actionCache);
+    }
 }
 
 SimpleExecutor::
@@ -43,6 +62,17 @@ SimpleExecutor::
 {
 }
 
+/*
+ * The invocations for one target, created before the build starts.
+ */
+struct TargetInvocations {
+    pbxproj::PBX::Target::shared_ptr                target;
+    std::vector<std::string>                        executablePaths;
+    std::vector<pbxbuild::Tool::AuxiliaryFile>      auxiliaryFiles;
+    std::vector<pbxbuild::Tool::Invocation>         invocations;
+    std::vector<pbxbuild::Tool::Invocation const *> orderedInvocations;
+};
+
 bool SimpleExecutor::
 build(
     process::User const *user,
@@ -75,92 +105,148 @@ build(
         return false;
     }
 
+    /*
+     * Create all of the target environments up front, in parallel.
+     */
+    buildContext->createTargetEnvironments(buildEnvironment, *orderedTargets);
+
+    /*
+     * Create the invocations for every target before starting the build, so
+     * invocations from independent targets can be scheduled together.
+     */
+    std::vector<TargetInvocations> targets;
+    targets.reserve(orderedTargets->size());
     for (pbxproj::PBX::Target::shared_ptr const &target : *orderedTargets) {
-        xcformatter::Formatter::Print(_formatter->beginTarget(*buildContext, target));
-
         ext::optional<pbxbuild::Target::Environment> targetEnvironment = buildContext->targetEnvironment(buildEnvironment, target);
         if (!targetEnvironment) {
             fprintf(stderr, "error: couldn't create target environment for %s\n", target->name().c_str());
-            xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
             return false;
         }
 
-        xcformatter::Formatter::Print(_formatter->beginCheckDependencies(target));
         pbxbuild::Phase::Environment phaseEnvironment = pbxbuild::Phase::Environment(buildEnvironment, *buildContext, target, *targetEnvironment);
         pbxbuild::Phase::PhaseInvocations phaseInvocations = pbxbuild::Phase::PhaseInvocations::Create(phaseEnvironment, target);
-        xcformatter::Formatter::Print(_formatter->finishCheckDependencies(target));
 
-        auto result = buildTarget(processContext, processLauncher, filesystem, target, *targetEnvironment, phaseInvocations.auxiliaryFiles(), phaseInvocations.invocations());
-        if (!result.first) {
-            xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
-            xcformatter::Formatter::Print(_formatter->failure(*buildContext, result.second));
+        targets.push_back(TargetInvocations());
+        TargetInvocations &targetInvocations = targets.back();
+        targetInvocations.target = target;
+        targetInvocations.executablePaths = targetEnvironment->executablePaths();
+        targetInvocations.auxiliaryFiles = phaseInvocations.auxiliaryFiles();
+        targetInvocations.invocations = phaseInvocations.invocations();
+
+        ext::optional<std::vector<pbxbuild::Tool::Invocation const *>> orderedInvocations = BuildGraph::SortInvocations(targetInvocations.invocations);
+        if (!orderedInvocations) {
+            fprintf(stderr, "error: cycle detected building invocation graph\n");
             return false;
         }
+        targetInvocations.orderedInvocations = std::move(*orderedInvocations);
+    }
 
-        xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
+    /* Held while formatting or printing output, so concurrent jobs don't interleave. */
+    std::mutex outputMutex;
+
+    /*
+     * Load the record of the last build, to skip invocations that are already
+     * up to date. It's stored with the build-level intermediates, resolved
+     * with the same configuration and overrides the targets build with.
+     */
+    pbxsetting::Environment environment = pbxsetting::Environment(buildEnvironment.baseEnvironment());
+    environment.insertFront(buildContext->baseSettings(), false);
+    environment.insertFront(buildContext->actionSettings(), false);
+    for (pbxsetting::Level const &level : buildContext->overrideLevels()) {
+        environment.insertFront(level, false);
     }
+    std::string databasePath = environment.resolve("OBJROOT") + "/" + ".simple-database";
 
-    xcformatter::Formatter::Print(_formatter->success(*buildContext));
-    return true;
-}
+    BuildDatabase database(_digests ? &_digestCache : nullptr);
+    if (!_dryRun) {
+        database.load(filesystem, databasePath);
+    }
 
-static ext::optional<std::vector<pbxbuild::Tool::Invocation>>
-SortInvocations(std::vector<pbxbuild::Tool::Invocation> const &invocations)
-{
-    std::unordered_map<std::string, pbxbuild::Tool::Invocation const *> outputToInvocation;
-    std::set<uint32_t, std::less<uint32_t>> orderedPhasePriorities;
-    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
-        for (std::string const &output : invocation.outputs()) {
-            outputToInvocation.insert({ output, &invocation });
+    /*
+     * Build one graph of jobs for the whole build. Without parallel targets,
+     * each target also waits for the previous target.
+     */
+    BuildGraph graph;
+    std::unordered_map<pbxproj::PBX::Target::shared_ptr, size_t> targetIndexes;
+    for (size_t t = 0; t < targets.size(); t++) {
+        pbxproj::PBX::Target::shared_ptr const &target = targets[t].target;
+
+        std::vector<size_t> targetDependencies;
+        for (pbxproj::PBX::Target::shared_ptr const &dependency : targetGraph->adjacent(target)) {
+            auto it = targetIndexes.find(dependency);
+            if (it != targetIndexes.end()) {
+                targetDependencies.push_back(it->second);
+            }
+        }
+        if (!_parallelizeTargets && t > 0) {
+            targetDependencies.push_back(t - 1);
         }
-        orderedPhasePriorities.insert(invocation.priority());
+
+        targetIndexes[target] = graph.addTarget(targetDependencies, targets[t].orderedInvocations);
     }
 
-    pbxbuild::DirectedGraph<pbxbuild::Tool::Invocation const *> graph;
-    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
-        std::unordered_set<pbxbuild::Tool::Invocation const *> emptySet;
-        graph.insert(&invocation, emptySet);
+    auto runJob = [&](BuildGraph::Job const &job) -> bool {
+        TargetInvocations const &targetInvocations = targets[job.target()];
+        pbxproj::PBX::Target::shared_ptr const &target = targetInvocations.target;
+
+        switch (job.type()) {
+            case BuildGraph::Job::Type::BeginTarget: {
+                std::lock_guard<std::mutex> lock(outputMutex);
 
-        for (std::string const &input : invocation.inputs()) {
-            auto it = outputToInvocation.find(input);
-            if (it != outputToInvocation.end()) {
-                graph.insert(&invocation, { it->second });
+                xcformatter::Formatter::Print(_formatter->beginTarget(*buildContext, target));
+                xcformatter::Formatter::Print(_formatter->beginCheckDependencies(target));
+                xcformatter::Formatter::Print(_formatter->finishCheckDependencies(target));
+
+                xcformatter::Formatter::Print(_formatter->beginWriteAuxiliaryFiles(target));
+                bool auxiliaryFilesSuccess = this->writeAuxiliaryFiles(filesystem, targetInvocations.auxiliaryFiles);
+                xcformatter::Formatter::Print(_formatter->finishWriteAuxiliaryFiles(target));
+                if (!auxiliaryFilesSuccess) {
+                    return false;
+                }
+
+                xcformatter::Formatter::Print(_formatter->beginCreateProductStructure(target));
+                return true;
             }
-        }
-        for (std::string const &phonyInputs : invocation.phonyInputs()) {
-            auto it = outputToInvocation.find(phonyInputs);
-            if (it != outputToInvocation.end()) {
-                graph.insert(&invocation, { it->second });
+            case BuildGraph::Job::Type::Invocation: {
+                return this->performInvocation(processContext, processLauncher, filesystem, targetInvocations.executablePaths, *job.invocation(), job.createProductStructure(), &outputMutex, &database);
             }
-        }
-        for (std::string const &inputDependency : invocation.inputDependencies()) {
-            auto it = outputToInvocation.find(inputDependency);
-            if (it != outputToInvocation.end()) {
-                graph.insert(&invocation, { it->second });
+            case BuildGraph::Job::Type::FinishProductStructure: {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                xcformatter::Formatter::Print(_formatter->finishCreateProductStructure(target));
+                return true;
             }
-        }
-
-        auto it = orderedPhasePriorities.find(invocation.priority());
-        if (it != orderedPhasePriorities.end() && std::next(it) != orderedPhasePriorities.end()) {
-            for (pbxbuild::Tool::Invocation const &otherInvocation : invocations) {
-                if (otherInvocation.priority() == *std::next(it)) {
-                    graph.insert(&otherInvocation, { &invocation });
-                }
+            case BuildGraph::Job::Type::FinishTarget: {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                xcformatter::Formatter::Print(_formatter->finishTarget(*buildContext, target));
+                return true;
             }
+            default: abort();
         }
-    }
+    };
 
-    std::vector<pbxbuild::Tool::Invocation> result;
+    std::vector<size_t> failed = _scheduler.run(graph.dependencies(), [&](size_t job) -> bool {
+        return runJob(graph.jobs()[job]);
+    });
 
-    ext::optional<std::vector<pbxbuild::Tool::Invocation const *>> orderedInvocations = graph.ordered();
-    if (!orderedInvocations) {
-        return ext::nullopt;
+    /* Save even if the build failed, so the invocations that succeeded aren't repeated. */
+    if (!_dryRun && !database.save(filesystem, databasePath)) {
+        fprintf(stderr, "warning: failed to write build database %s\n", databasePath.c_str());
     }
 
-    for (pbxbuild::Tool::Invocation const *invocation : *orderedInvocations) {
-        result.push_back(*invocation);
+    if (!failed.empty()) {
+        std::vector<pbxbuild::Tool::Invocation> failedInvocations;
+        for (size_t job : failed) {
+            if (graph.jobs()[job].invocation() != nullptr) {
+                failedInvocations.push_back(*graph.jobs()[job].invocation());
+            }
+        }
+
+        xcformatter::Formatter::Print(_formatter->failure(*buildContext, failedInvocations));
+        return false;
     }
-    return result;
+
+    xcformatter::Formatter::Print(_formatter->success(*buildContext));
+    return true;
 }
 
 bool SimpleExecutor::
@@ -203,8 +289,12 @@ writeAuxiliaryFiles(
                 }
             }
 
-            if (!filesystem->write(data, auxiliaryFile.path())) {
-                return false;
+            /* Leave unchanged files alone, so invocations reading them stay up to date. */
+            std::vector<uint8_t> existing;
+            if (filesystem->type(auxiliaryFile.path()) != Filesystem::Type::File || !filesystem->read(&existing, auxiliaryFile.path()) || existing != data) {
+                if (!filesystem->write(data, auxiliaryFile.path())) {
+                    return false;
+                }
             }
         }
 
@@ -226,143 +316,321 @@ writeAuxiliaryFiles(
     return true;
 }
 
-std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
-performInvocations(
+/*
+ * Hash of everything that determines what an invocation's command does. The
+ * tool is the file that implements the executable; its size and modification
+ * time are included so that updating it runs the invocation again.
+ */
+static std::string
+InvocationCommand(
+    Filesystem const *filesystem,
+    pbxbuild::Tool::Invocation const &invocation,
+    std::string const &executable,
+    std::string const &tool,
+    std::unordered_map<std::string, std::string> const &environment)
+{
+    Digest digest;
+
+    digest.appendTerminated(executable);
+
+    uint64_t size;
+    uint64_t modified;
+    if (filesystem->readFileInfo(tool, &size, &modified)) {
+        digest.appendTerminated(std::to_string(size));
+        digest.appendTerminated(std::to_string(modified));
+    }
+
+    digest.appendTerminated(invocation.workingDirectory());
+
+    for (std::string const &argument : invocation.arguments()) {
+        digest.appendTerminated(argument);
+    }
+
+    /* Environment order is not meaningful. */
+    std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(environment.begin(), environment.end());
+    for (std::pair<std::string const, std::string> const &variable : sortedEnvironment) {
+        digest.appendTerminated(variable.first);
+        digest.appendTerminated(variable.second);
+    }
+
+    return digest.finish();
+}
+
+static bool
+LoadDependencyInfo(Filesystem const *filesystem, pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo, std::vector<std::string> *inputs)
+{
+    std::vector<dependency::DependencyInfo> info;
+
+    if (dependencyInfo.format() == dependency::DependencyInfoFormat::Binary) {
+        std::vector<uint8_t> contents;
+        if (!filesystem->read(&contents, dependencyInfo.path())) {
+            return false;
+        }
+
+        auto binaryInfo = dependency::BinaryDependencyInfo::Deserialize(contents);
+        if (!binaryInfo) {
+            return false;
+        }
+
+        info.push_back(binaryInfo->dependencyInfo());
+    } else if (dependencyInfo.format() == dependency::DependencyInfoFormat::Directory) {
+        auto directoryInfo = dependency::DirectoryDependencyInfo::Deserialize(filesystem, dependencyInfo.path());
+        if (!directoryInfo) {
+            return false;
+        }
+
+        info.push_back(directoryInfo->dependencyInfo());
+    } else if (dependencyInfo.format() == dependency::DependencyInfoFormat::Makefile) {
+        std::vector<uint8_t> contents;
+        if (!filesystem->read(&contents, dependencyInfo.path())) {
+            return false;
+        }
+
+        auto makefileInfo = dependency::MakefileDependencyInfo::Deserialize(std::string(contents.begin(), contents.end()));
+        if (!makefileInfo) {
+            return false;
+        }
+
+        info = makefileInfo->dependencyInfo();
+    } else {
+        return false;
+    }
+
+    for (dependency::DependencyInfo const &entry : info) {
+        inputs->insert(inputs->end(), entry.inputs().begin(), entry.inputs().end());
+    }
+
+    return true;
+}
+
+/*
+ * The files an invocation read that weren't declared, from its dependency
+ * info. Fails if the dependency info couldn't be loaded.
+ */
+static bool
+DiscoveredInputs(Filesystem const *filesystem, pbxbuild::Tool::Invocation const &invocation, std::vector<std::string> *inputs)
+{
+    for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+        std::vector<std::string> discovered;
+        if (!LoadDependencyInfo(filesystem, dependencyInfo, &discovered)) {
+            return false;
+        }
+
+        for (std::string const &input : discovered) {
+            inputs->push_back(FSUtil::ResolveRelativePath(input, invocation.workingDirectory()));
+        }
+    }
+
+    return true;
+}
+
+bool SimpleExecutor::
+performInvocation(
     process::Context const *processContext,
     process::Launcher *processLauncher,
     Filesystem *filesystem,
     std::vector<std::string> const &executablePaths,
-    std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
-    bool createProductStructure)
+    pbxbuild::Tool::Invocation const &invocation,
+    bool createProductStructure,
+    std::mutex *outputMutex,
+    BuildDatabase *database)
 {
-    for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
-        // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
-        if (!invocation.executable()) {
-            continue;
-        }
-        pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
+    if (_dryRun) {
+        return true;
+    }
 
-        if (invocation.createsProductStructure() != createProductStructure) {
-            continue;
+    // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
+    if (!invocation.executable()) {
+        return true;
+    }
+    pbxbuild::Tool::Invocation::Executable const &executable = *invocation.executable();
+
+    std::shared_ptr<builtin::Driver> driver;
+    std::string path;
+    if (ext::optional<std::string> const &builtin = executable.builtin()) {
+        /* Builtin tool, find and run in-process. */
+        driver = _builtins.driver(*builtin);
+        if (driver == nullptr) {
+            /* Failed to find builtin tool. */
+            return false;
         }
 
-        if (!_dryRun) {
-            bool success = true;
+        path = *builtin;
+    } else if (ext::optional<std::string> const &external = executable.external()) {
+        /* External tool, find on the filesystem. */
+        ext::optional<std::string> found;
+        if (FSUtil::IsAbsolutePath(*external)) {
+            if (filesystem->isExecutable(*external)) {
+                found = external;
+            }
+        } else {
+            found = filesystem->findExecutable(*external, executablePaths);
+        }
 
-            for (std::string const &output : invocation.outputs()) {
-                std::string directory = FSUtil::GetDirectoryName(output);
+        if (!found) {
+            /* Failed to find executable. */
+            return false;
+        }
 
-                if (!filesystem->createDirectory(directory, true)) {
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
-                }
-            }
+        path = *found;
+    } else {
+        abort();
+    }
 
-            if (ext::optional<std::string> const &builtin = executable.builtin()) {
-                /* Builtin tool, find and run in-process. */
-                if (std::shared_ptr<builtin::Driver> driver = _builtins.driver(*builtin)) {
-                    xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *builtin, createProductStructure));
+    /* External tools also get the process environment, preferring the invocation's. */
+    std::unordered_map<std::string, std::string> environment = invocation.environment();
+    if (driver == nullptr) {
+        environment.insert(processContext->environmentVariables().begin(), processContext->environmentVariables().end());
+    }
 
-                    process::MemoryContext context = process::MemoryContext(
-                        *builtin,
-                        invocation.workingDirectory(),
-                        invocation.arguments(),
-                        invocation.environment());
-                    int exitCode = driver->run(&context, filesystem);
-                    success = (exitCode == 0);
+    std::string command;
+    if (database != nullptr || _actionCache) {
+        /* Builtins run in this process, so are implemented by its executable. */
+        std::string const &tool = (driver != nullptr ? processContext->executablePath() : path);
+        command = InvocationCommand(filesystem, invocation, path, tool, environment);
+    }
 
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, *builtin, createProductStructure));
-                } else {
-                    /* Failed to find builtin tool. */
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
-                }
-            } else if (ext::optional<std::string> const &external = executable.external()) {
-                /* External tool, find on the filesystem. */
-                ext::optional<std::string> path;
-                if (FSUtil::IsAbsolutePath(*external)) {
-                    if (filesystem->isExecutable(*external)) {
-                        path = external;
-                    }
-                } else {
-                    path = filesystem->findExecutable(*external, executablePaths);
-                }
+    /* Skip invocations that haven't changed since they last ran. */
+    if (database != nullptr) {
+        if (database->upToDate(filesystem, invocation.outputs(), command)) {
+            return true;
+        }
+    }
 
-                if (path) {
-                    xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *path, createProductStructure));
+    std::vector<std::string> declaredInputs = invocation.inputs();
+    declaredInputs.insert(declaredInputs.end(), invocation.inputDependencies().begin(), invocation.inputDependencies().end());
 
-                    /* Create the execution environment from the process and invocation environments, preferring the invocation. */
-                    std::unordered_map<std::string, std::string> environment = invocation.environment();
-                    environment.insert(processContext->environmentVariables().begin(), processContext->environmentVariables().end());
+    /* Read the declared inputs before starting, so changes made while running aren't recorded. */
+    uint64_t started = filesystem->currentTime();
+    ext::optional<std::vector<BuildDatabase::File>> declaredFiles;
+    if (database != nullptr) {
+        declaredFiles = database->read(filesystem, declaredInputs);
+    }
 
-                    process::MemoryContext context = process::MemoryContext(
-                        *path,
-                        invocation.workingDirectory(),
-                        invocation.arguments(),
-                        environment);
-                    ext::optional<int> exitCode = processLauncher->launch(filesystem, &context);
-                    success = (exitCode && *exitCode == 0);
+    /*
+     * Reuse the outputs of an identical earlier invocation from the action cache.
+     * Invocations without declared inputs could read anything, so aren't cached.
+     */
+    ext::optional<std::string> action;
+    std::vector<std::string> cachedOutputs;
+    if (_actionCache && !invocation.outputs().empty() && !invocation.inputs().empty()) {
+        /* Cache the dependency info too, so it's available after restoring. */
+        cachedOutputs = invocation.outputs();
+        for (pbxbuild::Tool::Invocation::DependencyInfo const &dependencyInfo : invocation.dependencyInfo()) {
+            cachedOutputs.push_back(dependencyInfo.path());
+        }
 
-                    xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, *path, createProductStructure));
+        action = ActionCache::ActionKey(filesystem, &_digestCache, command, declaredInputs);
+        if (action && _actionCache->restore(filesystem, &_digestCache, *action, cachedOutputs)) {
+            if (database != nullptr) {
+                std::vector<std::string> discovered;
+                if (declaredFiles && DiscoveredInputs(filesystem, invocation, &discovered)) {
+                    database->record(filesystem, invocation.outputs(), command, *declaredFiles, discovered, started);
                 } else {
-                    /* Failed to find executable. */
-                    return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
+                    database->remove(invocation.outputs());
                 }
-            } else {
-                abort();
-            }
-
-            if (!success) {
-                return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
             }
+            return true;
         }
     }
 
-    return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
-}
+    for (std::string const &output : invocation.outputs()) {
+        std::string directory = FSUtil::GetDirectoryName(output);
 
-std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
-buildTarget(
-    process::Context const *processContext,
-    process::Launcher *processLauncher,
-    Filesystem *filesystem,
-    pbxproj::PBX::Target::shared_ptr const &target,
-    pbxbuild::Target::Environment const &targetEnvironment,
-    std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
-    std::vector<pbxbuild::Tool::Invocation> const &invocations)
-{
-    xcformatter::Formatter::Print(_formatter->beginWriteAuxiliaryFiles(target));
-    bool auxiliaryFilesSuccess = this->writeAuxiliaryFiles(filesystem, auxiliaryFiles);
-    xcformatter::Formatter::Print(_formatter->finishWriteAuxiliaryFiles(target));
-    if (!auxiliaryFilesSuccess) {
-        return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
+        if (!filesystem->createDirectory(directory, true)) {
+            return false;
+        }
     }
 
-    ext::optional<std::vector<pbxbuild::Tool::Invocation>> orderedInvocations = SortInvocations(invocations);
-    if (!orderedInvocations) {
-        fprintf(stderr, "error: cycle detected building invocation graph\n");
-        return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>());
+    bool success;
+    if (driver != nullptr) {
+        /* Builtins write their output directly, so they run one at a time while holding the output. */
+        std::lock_guard<std::mutex> lock(*outputMutex);
+
+        xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, path, createProductStructure));
+
+        process::MemoryContext context = process::MemoryContext(
+            path,
+            invocation.workingDirectory(),
+            invocation.arguments().value(),
+            environment);
+        int exitCode = driver->run(&context, filesystem);
+
+        xcformatter::Formatter::Print(_formatter->finishInvocation(invocation, path, createProductStructure));
+        success = (exitCode == 0);
+    } else {
+        /*
+         * With more than one job, each invocation's output is collected and printed
+         * together once it finishes, so the output of concurrent invocations isn't
+         * interleaved. The formatter is only used while holding the output lock.
+         */
+        bool buffered = (_scheduler.workers() > 1);
+
+        std::string output;
+        {
+            std::lock_guard<std::mutex> lock(*outputMutex);
+            std::string message = _formatter->beginInvocation(invocation, path, createProductStructure);
+            if (buffered) {
+                output += message;
+            } else {
+                xcformatter::Formatter::Print(message);
+            }
+        }
+
+        process::MemoryContext context = process::MemoryContext(
+            path,
+            invocation.workingDirectory(),
+            invocation.arguments().value(),
+            environment);
+        ext::optional<int> exitCode = processLauncher->launch(filesystem, &context, (buffered ? &output : nullptr));
+
+        {
+            std::lock_guard<std::mutex> lock(*outputMutex);
+            std::string message = _formatter->finishInvocation(invocation, path, createProductStructure);
+            if (buffered) {
+                output += message;
+                xcformatter::Formatter::Print(output);
+            } else {
+                xcformatter::Formatter::Print(message);
+            }
+        }
+
+        success = (exitCode && *exitCode == 0);
     }
 
-    xcformatter::Formatter::Print(_formatter->beginCreateProductStructure(target));
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> structureResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, true);
-    xcformatter::Formatter::Print(_formatter->finishCreateProductStructure(target));
-    if (!structureResult.first) {
-        return structureResult;
+    std::vector<std::string> discovered;
+    bool discoveredFound = (success && DiscoveredInputs(filesystem, invocation, &discovered));
+
+    if (database != nullptr) {
+        if (discoveredFound && declaredFiles) {
+            database->record(filesystem, invocation.outputs(), command, *declaredFiles, discovered, started);
+        } else {
+            database->remove(invocation.outputs());
+        }
     }
 
-    std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> invocationsResult = performInvocations(processContext, processLauncher, filesystem, targetEnvironment.executablePaths(), *orderedInvocations, false);
-    if (!invocationsResult.first) {
-        return invocationsResult;
+    /* Only cache if the declared inputs are the ones the action key describes. */
+    if (action && discoveredFound && ActionCache::ActionKey(filesystem, &_digestCache, command, declaredInputs) == action) {
+        std::vector<std::string> inputs = declaredInputs;
+        inputs.insert(inputs.end(), discovered.begin(), discovered.end());
+
+        /* Failing to cache only means the invocation will run again. */
+        _actionCache->store(filesystem, &_digestCache, *action, inputs, cachedOutputs, started);
     }
 
-    return std::make_pair(true, std::vector<pbxbuild::Tool::Invocation>());
+    return success;
 }
 
 std::unique_ptr<SimpleExecutor> SimpleExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, builtin::Registry const &builtins, size_t jobs, bool parallelizeTargets, bool digests, ext::optional<std::string> const &actionCache)
 {
     return std::unique_ptr<SimpleExecutor>(new SimpleExecutor(
         formatter,
         dryRun,
-        builtins
+        builtins,
+        jobs,
+        parallelizeTargets,
+        digests,
+        actionCache
     ));
 }
@@ -0,0 +1,114 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/ActionCache.h>
+#include <xcexecution/DigestCache.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcexecution::ActionCache;
+using xcexecution::DigestCache;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+TEST(ActionCache, ActionKey)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::Directory("directory", { }),
+    });
+    DigestCache digests;
+
+    ext::optional<std::string> key = ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("input") });
+    ASSERT_TRUE(key);
+    EXPECT_EQ(key, ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("input") }));
+    EXPECT_NE(key, ActionCache::ActionKey(&filesystem, &digests, "other", { filesystem.path("input") }));
+    EXPECT_NE(key, ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("input"), filesystem.path("missing") }));
+
+    /* Input contents are part of the key. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), filesystem.path("input")));
+    EXPECT_NE(key, ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("input") }));
+
+    /* Directory inputs can't be cached. */
+    EXPECT_FALSE(ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("directory") }));
+}
+
+TEST(ActionCache, StoreRestore)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("header", Contents("header")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    std::string output = filesystem.path("build/output");
+    ASSERT_TRUE(filesystem.createDirectory(filesystem.path("build"), false));
+    ASSERT_TRUE(filesystem.write(Contents("output"), output));
+    DigestCache digests;
+
+    /* The action started after all of the files were written. */
+    uint64_t started = filesystem.currentTime();
+
+    ActionCache cache = ActionCache(filesystem.path("cache"));
+    std::string action = *ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("input") });
+    EXPECT_FALSE(cache.restore(&filesystem, &digests, action, { output }));
+
+    /* Store with a discovered input, then restore the removed output. */
+    ASSERT_TRUE(cache.store(&filesystem, &digests, action, { filesystem.path("input"), filesystem.path("header") }, { output }, started));
+    ASSERT_TRUE(filesystem.removeFile(output));
+    ASSERT_TRUE(cache.restore(&filesystem, &digests, action, { output }));
+
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(filesystem.read(&contents, output));
+    EXPECT_EQ(Contents("output"), contents);
+
+    /* Only the expected outputs are restored. */
+    EXPECT_FALSE(cache.restore(&filesystem, &digests, action, { filesystem.path("other") }));
+    EXPECT_FALSE(cache.restore(&filesystem, &digests, action, { output, filesystem.path("other") }));
+    EXPECT_FALSE(filesystem.exists(filesystem.path("other")));
+
+    /* No temporary files are left in the cache. */
+    std::vector<std::string> blobs;
+    ASSERT_TRUE(filesystem.readDirectory(filesystem.path("cache/blobs"), false, [&](std::string const &name) {
+        blobs.push_back(name);
+    }));
+    EXPECT_EQ(1, blobs.size());
+
+    /* Changing a discovered input misses. */
+    ASSERT_TRUE(filesystem.write(Contents("header changed"), filesystem.path("header")));
+    EXPECT_FALSE(cache.restore(&filesystem, &digests, action, { output }));
+
+    /* Missing outputs can't be stored. */
+    EXPECT_FALSE(cache.store(&filesystem, &digests, action, { filesystem.path("input") }, { filesystem.path("missing") }, started));
+}
+
+TEST(ActionCache, ChangedWhileRunning)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("header", Contents("header")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    std::string output = filesystem.path("output");
+    DigestCache digests;
+
+    uint64_t started = filesystem.currentTime();
+
+    ActionCache cache = ActionCache(filesystem.path("cache"));
+    std::string action = *ActionCache::ActionKey(&filesystem, &digests, "command", { filesystem.path("input") });
+
+    /* A discovered input written after the action started isn't stored. */
+    ASSERT_TRUE(filesystem.write(Contents("header changed"), filesystem.path("header")));
+    EXPECT_FALSE(cache.store(&filesystem, &digests, action, { filesystem.path("input"), filesystem.path("header") }, { output }, started));
+    EXPECT_FALSE(cache.restore(&filesystem, &digests, action, { output }));
+}
@@ -0,0 +1,175 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/BuildDatabase.h>
+#include <xcexecution/DigestCache.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcexecution::BuildDatabase;
+using xcexecution::DigestCache;
+using libutil::Filesystem;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static void
+Record(BuildDatabase *database, Filesystem const *filesystem, std::vector<std::string> const &outputs, std::string const &command, std::vector<std::string> const &inputs)
+{
+    ext::optional<std::vector<BuildDatabase::File>> files = database->read(filesystem, inputs);
+    ASSERT_TRUE(files);
+    database->record(filesystem, outputs, command, *files, { }, UINT64_MAX);
+}
+
+TEST(BuildDatabase, UpToDate)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("header", Contents("header")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    std::vector<std::string> outputs = { filesystem.path("output") };
+    std::vector<std::string> inputs = { filesystem.path("input"), filesystem.path("header"), filesystem.path("missing") };
+
+    BuildDatabase database;
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "command"));
+
+    Record(&database, &filesystem, outputs, "command", inputs);
+    EXPECT_TRUE(database.upToDate(&filesystem, outputs, "command"));
+
+    /* Changed commands are not up to date. */
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "other"));
+
+    /* Changed inputs are not up to date. */
+    ASSERT_TRUE(filesystem.write(Contents("header changed"), filesystem.path("header")));
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "command"));
+    Record(&database, &filesystem, outputs, "command", inputs);
+    EXPECT_TRUE(database.upToDate(&filesystem, outputs, "command"));
+
+    /* Created inputs are not up to date. */
+    ASSERT_TRUE(filesystem.write(Contents("missing"), filesystem.path("missing")));
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "command"));
+    Record(&database, &filesystem, outputs, "command", inputs);
+
+    /* Removed outputs are not up to date. */
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("output")));
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "command"));
+}
+
+TEST(BuildDatabase, NotRecorded)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::Directory("directory", { }),
+    });
+
+    BuildDatabase database;
+
+    /* Invocations without outputs always run. */
+    Record(&database, &filesystem, { }, "command", { filesystem.path("input") });
+    EXPECT_FALSE(database.upToDate(&filesystem, { }, "command"));
+
+    /* Nor do invocations with missing or directory outputs. */
+    Record(&database, &filesystem, { filesystem.path("missing") }, "command", { filesystem.path("input") });
+    EXPECT_FALSE(database.upToDate(&filesystem, { filesystem.path("missing") }, "command"));
+    Record(&database, &filesystem, { filesystem.path("directory") }, "command", { filesystem.path("input") });
+    EXPECT_FALSE(database.upToDate(&filesystem, { filesystem.path("directory") }, "command"));
+}
+
+TEST(BuildDatabase, SaveLoad)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input one", Contents("input")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    std::vector<std::string> outputs = { filesystem.path("output") };
+    std::vector<std::string> inputs = { filesystem.path("input one"), filesystem.path("missing") };
+
+    BuildDatabase database;
+    Record(&database, &filesystem, outputs, "command", inputs);
+    ASSERT_TRUE(database.save(&filesystem, filesystem.path("build/database")));
+
+    BuildDatabase loaded;
+    loaded.load(&filesystem, filesystem.path("build/database"));
+    EXPECT_TRUE(loaded.upToDate(&filesystem, outputs, "command"));
+
+    /* Missing inputs are preserved. */
+    ASSERT_TRUE(filesystem.write(Contents("missing"), filesystem.path("missing")));
+    EXPECT_FALSE(loaded.upToDate(&filesystem, outputs, "command"));
+
+    /* Invalid databases are empty. */
+    ASSERT_TRUE(filesystem.write(Contents("invalid"), filesystem.path("build/database")));
+    BuildDatabase invalid;
+    invalid.load(&filesystem, filesystem.path("build/database"));
+    EXPECT_FALSE(invalid.upToDate(&filesystem, outputs, "command"));
+}
+
+TEST(BuildDatabase, Digests)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    std::vector<std::string> outputs = { filesystem.path("output") };
+    std::vector<std::string> inputs = { filesystem.path("input") };
+
+    BuildDatabase timestamps;
+    Record(&timestamps, &filesystem, outputs, "command", inputs);
+    DigestCache cache;
+    BuildDatabase digests(&cache);
+    Record(&digests, &filesystem, outputs, "command", inputs);
+
+    /* Rewrite the input with the same contents, changing its modification time. */
+    ASSERT_TRUE(filesystem.write(Contents("input"), filesystem.path("input")));
+
+    /* Without digests, a new modification time is a change. */
+    EXPECT_FALSE(timestamps.upToDate(&filesystem, outputs, "command"));
+
+    /* With digests, the same contents are unchanged. */
+    EXPECT_TRUE(digests.upToDate(&filesystem, outputs, "command"));
+
+    /* But different contents of the same size are a change. */
+    ASSERT_TRUE(filesystem.write(Contents("INPUT"), filesystem.path("input")));
+    EXPECT_FALSE(digests.upToDate(&filesystem, outputs, "command"));
+}
+
+TEST(BuildDatabase, ChangedWhileRunning)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("input", Contents("input")),
+        MemoryFilesystem::Entry::File("header", Contents("header")),
+        MemoryFilesystem::Entry::File("output", Contents("output")),
+    });
+    std::vector<std::string> outputs = { filesystem.path("output") };
+
+    BuildDatabase database;
+
+    /* Declared inputs are recorded as they were before running. */
+    ext::optional<std::vector<BuildDatabase::File>> inputs = database.read(&filesystem, { filesystem.path("input") });
+    ASSERT_TRUE(inputs);
+    ASSERT_TRUE(filesystem.write(Contents("edited"), filesystem.path("input")));
+    database.record(&filesystem, outputs, "command", *inputs, { }, UINT64_MAX);
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "command"));
+
+    /* Discovered inputs modified after starting aren't recorded. */
+    inputs = database.read(&filesystem, { filesystem.path("input") });
+    ASSERT_TRUE(inputs);
+    uint64_t started = filesystem.currentTime();
+    ASSERT_TRUE(filesystem.write(Contents("header"), filesystem.path("header")));
+    database.record(&filesystem, outputs, "command", *inputs, { filesystem.path("header") }, started);
+    EXPECT_FALSE(database.upToDate(&filesystem, outputs, "command"));
+
+    started = filesystem.currentTime();
+    database.record(&filesystem, outputs, "command", *inputs, { filesystem.path("header") }, started);
+    EXPECT_TRUE(database.upToDate(&filesystem, outputs, "command"));
+}
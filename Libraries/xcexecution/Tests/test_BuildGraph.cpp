@@ -0,0 +1,205 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/BuildGraph.h>
+
+#include <algorithm>
+
+using xcexecution::BuildGraph;
+
+static pbxbuild::Tool::Invocation
+Invocation(std::vector<std::string> const &inputs, std::vector<std::string> const &outputs, bool createsProductStructure = false)
+{
+    pbxbuild::Tool::Invocation invocation;
+    invocation.inputs() = inputs;
+    invocation.outputs() = outputs;
+    invocation.createsProductStructure() = createsProductStructure;
+    return invocation;
+}
+
+static size_t
+FindJob(BuildGraph const &graph, BuildGraph::Job::Type type, size_t target, pbxbuild::Tool::Invocation const *invocation = nullptr)
+{
+    for (size_t n = 0; n < graph.jobs().size(); n++) {
+        BuildGraph::Job const &job = graph.jobs()[n];
+        if (job.type() == type && job.target() == target && job.invocation() == invocation) {
+            return n;
+        }
+    }
+
+    ADD_FAILURE() << "job not found";
+    return 0;
+}
+
+/*
+ * If job `from` can only start after job `to` finished.
+ */
+static bool
+DependsOn(BuildGraph const &graph, size_t from, size_t to)
+{
+    for (size_t dependency : graph.jobs()[from].dependencies()) {
+        if (dependency == to || DependsOn(graph, dependency, to)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+ExpectEdgesPointBackwards(BuildGraph const &graph)
+{
+    for (size_t n = 0; n < graph.jobs().size(); n++) {
+        for (size_t dependency : graph.jobs()[n].dependencies()) {
+            EXPECT_LT(dependency, n);
+        }
+    }
+}
+
+TEST(BuildGraph, TargetOrdering)
+{
+    auto first = Invocation({ }, { "first" });
+    auto second = Invocation({ }, { "second" });
+    auto independent = Invocation({ }, { "independent" });
+
+    BuildGraph graph;
+    size_t firstTarget = graph.addTarget({ }, { &first });
+    size_t secondTarget = graph.addTarget({ firstTarget }, { &second });
+    size_t independentTarget = graph.addTarget({ }, { &independent });
+    ExpectEdgesPointBackwards(graph);
+    EXPECT_EQ(graph.jobs().size(), graph.dependencies().size());
+
+    /* A target starts after the targets it depends on finish. */
+    size_t firstFinish = FindJob(graph, BuildGraph::Job::Type::FinishTarget, firstTarget);
+    EXPECT_TRUE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::BeginTarget, secondTarget), firstFinish));
+    EXPECT_TRUE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::Invocation, secondTarget, &second), firstFinish));
+
+    /* Independent targets don't wait for each other. */
+    EXPECT_FALSE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::Invocation, independentTarget, &independent), firstFinish));
+    EXPECT_FALSE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::Invocation, secondTarget, &second), FindJob(graph, BuildGraph::Job::Type::BeginTarget, independentTarget)));
+
+    /* A target finishes after its invocations. */
+    EXPECT_TRUE(DependsOn(graph, firstFinish, FindJob(graph, BuildGraph::Job::Type::Invocation, firstTarget, &first)));
+}
+
+TEST(BuildGraph, ProductStructure)
+{
+    auto compile = Invocation({ "source" }, { "object" });
+    auto link = Invocation({ "object" }, { "binary" });
+    auto structure = Invocation({ }, { "directory" }, true);
+
+    BuildGraph graph;
+    size_t target = graph.addTarget({ }, { &compile, &link, &structure });
+    ExpectEdgesPointBackwards(graph);
+
+    /* The product structure is created before any other invocations run. */
+    size_t structureJob = FindJob(graph, BuildGraph::Job::Type::Invocation, target, &structure);
+    size_t structureFinish = FindJob(graph, BuildGraph::Job::Type::FinishProductStructure, target);
+    EXPECT_TRUE(graph.jobs()[structureJob].createProductStructure());
+    EXPECT_TRUE(DependsOn(graph, structureFinish, structureJob));
+
+    size_t compileJob = FindJob(graph, BuildGraph::Job::Type::Invocation, target, &compile);
+    size_t linkJob = FindJob(graph, BuildGraph::Job::Type::Invocation, target, &link);
+    EXPECT_FALSE(graph.jobs()[compileJob].createProductStructure());
+    EXPECT_TRUE(DependsOn(graph, compileJob, structureFinish));
+    EXPECT_TRUE(DependsOn(graph, linkJob, structureFinish));
+
+    /* Invocations wait for the invocations producing their inputs. */
+    EXPECT_TRUE(DependsOn(graph, linkJob, compileJob));
+    EXPECT_FALSE(DependsOn(graph, compileJob, linkJob));
+}
+
+TEST(BuildGraph, CrossTargetInputs)
+{
+    auto generate = Invocation({ }, { "generated" });
+    auto other = Invocation({ }, { "other" });
+    auto consume = Invocation({ "generated" }, { "consumed" });
+    auto unrelated = Invocation({ "source" }, { "unrelated" });
+
+    /* Targets without a dependency between them still order shared files. */
+    BuildGraph graph;
+    size_t producer = graph.addTarget({ }, { &generate, &other });
+    size_t consumer = graph.addTarget({ }, { &consume, &unrelated });
+    ExpectEdgesPointBackwards(graph);
+
+    size_t generateJob = FindJob(graph, BuildGraph::Job::Type::Invocation, producer, &generate);
+    EXPECT_TRUE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::Invocation, consumer, &consume), generateJob));
+    EXPECT_FALSE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::Invocation, consumer, &consume), FindJob(graph, BuildGraph::Job::Type::Invocation, producer, &other)));
+    EXPECT_FALSE(DependsOn(graph, FindJob(graph, BuildGraph::Job::Type::Invocation, consumer, &unrelated), generateJob));
+}
+
+TEST(BuildGraph, InvocationDependencies)
+{
+    auto compile = Invocation({ "source" }, { "object" });
+    auto link = Invocation({ "object" }, { "binary" });
+    auto copy = Invocation({ "resource" }, { "copied" });
+    copy.priority() = 1;
+
+    std::vector<std::vector<size_t>> dependencies = BuildGraph::InvocationDependencies({ &compile, &link, &copy });
+    ASSERT_EQ(3, dependencies.size());
+    EXPECT_TRUE(dependencies[0].empty());
+    EXPECT_EQ(std::vector<size_t>({ 0 }), dependencies[1]);
+
+    /* Later phase priorities wait for all earlier invocations. */
+    std::sort(dependencies[2].begin(), dependencies[2].end());
+    EXPECT_EQ(std::vector<size_t>({ 0, 1 }), dependencies[2]);
+}
+
+/*
+ * The position of an invocation in a sorted order.
+ */
+static size_t
+Position(std::vector<pbxbuild::Tool::Invocation const *> const &order, pbxbuild::Tool::Invocation const *invocation)
+{
+    return std::distance(order.begin(), std::find(order.begin(), order.end(), invocation));
+}
+
+TEST(BuildGraph, SortInvocations)
+{
+    /* Listed out of order: later priorities first, and consumers before producers. */
+    std::vector<pbxbuild::Tool::Invocation> invocations = {
+        Invocation({ "copied" }, { "stamp" }),
+        Invocation({ "resource" }, { "copied" }),
+        Invocation({ "object" }, { "binary" }),
+        Invocation({ "source" }, { "object" }),
+        Invocation({ }, { "unrelated" }),
+    };
+    invocations[0].priority() = 2;
+    invocations[1].priority() = 1;
+
+    ext::optional<std::vector<pbxbuild::Tool::Invocation const *>> order = BuildGraph::SortInvocations(invocations);
+    ASSERT_TRUE(order);
+    ASSERT_EQ(invocations.size(), order->size());
+
+    /* The order points at the invocations passed in, each once. */
+    for (pbxbuild::Tool::Invocation const &invocation : invocations) {
+        EXPECT_EQ(1, std::count(order->begin(), order->end(), &invocation));
+    }
+
+    /* Invocations come after those producing their inputs. */
+    EXPECT_LT(Position(*order, &invocations[3]), Position(*order, &invocations[2]));
+    EXPECT_LT(Position(*order, &invocations[1]), Position(*order, &invocations[0]));
+
+    /* And after every invocation in an earlier phase priority. */
+    for (size_t n : { 2, 3, 4 }) {
+        EXPECT_LT(Position(*order, &invocations[n]), Position(*order, &invocations[1]));
+        EXPECT_LT(Position(*order, &invocations[n]), Position(*order, &invocations[0]));
+    }
+}
+
+TEST(BuildGraph, SortInvocationsCycle)
+{
+    std::vector<pbxbuild::Tool::Invocation> invocations = {
+        Invocation({ "second" }, { "first" }),
+        Invocation({ "first" }, { "second" }),
+    };
+
+    EXPECT_FALSE(BuildGraph::SortInvocations(invocations));
+}
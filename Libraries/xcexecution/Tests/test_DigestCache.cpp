@@ -0,0 +1,46 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/DigestCache.h>
+#include <libutil/Digest.h>
+#include <libutil/MemoryFilesystem.h>
+
+using xcexecution::DigestCache;
+using libutil::Digest;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+TEST(DigestCache, Digest)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file", Contents("file")),
+        MemoryFilesystem::Entry::Directory("directory", { }),
+    });
+
+    DigestCache digests;
+    EXPECT_EQ(Digest::Hex(std::string("file")), digests.digest(&filesystem, filesystem.path("file")));
+
+    /* Unchanged size and modification time reuse the digest without reading. */
+    filesystem.root().child("file")->contents() = Contents("FILE");
+    EXPECT_EQ(Digest::Hex(std::string("file")), digests.digest(&filesystem, filesystem.path("file")));
+
+    /* Writing the file changes its modification time. */
+    ASSERT_TRUE(filesystem.write(Contents("FILE"), filesystem.path("file")));
+    EXPECT_EQ(Digest::Hex(std::string("FILE")), digests.digest(&filesystem, filesystem.path("file")));
+
+    /* Only regular files have digests. */
+    EXPECT_EQ(ext::nullopt, digests.digest(&filesystem, filesystem.path("directory")));
+    EXPECT_EQ(ext::nullopt, digests.digest(&filesystem, filesystem.path("missing")));
+}
@@ -0,0 +1,82 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/Scheduler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+using xcexecution::Scheduler;
+
+TEST(Scheduler, SingleWorkerOrder)
+{
+    /* With one worker, jobs run in index order. */
+    std::vector<std::vector<size_t>> dependencies = { { }, { 0 }, { }, { 1, 2 } };
+
+    std::vector<size_t> order;
+    std::vector<size_t> failed = Scheduler(1).run(dependencies, [&](size_t job) {
+        order.push_back(job);
+        return true;
+    });
+
+    EXPECT_TRUE(failed.empty());
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 2, 3 }), order);
+}
+
+TEST(Scheduler, Dependencies)
+{
+    /* A wide graph: many independent jobs feeding a final job. */
+    size_t count = 64;
+    std::vector<std::vector<size_t>> dependencies = std::vector<std::vector<size_t>>(count + 1);
+    for (size_t n = 0; n < count; n++) {
+        dependencies[count].push_back(n);
+    }
+
+    std::mutex mutex;
+    std::vector<bool> finished = std::vector<bool>(count + 1, false);
+    bool ready = false;
+
+    std::vector<size_t> failed = Scheduler(4).run(dependencies, [&](size_t job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (job == count) {
+            ready = std::all_of(finished.begin(), finished.begin() + count, [](bool value) { return value; });
+        }
+        finished[job] = true;
+        return true;
+    });
+
+    EXPECT_TRUE(failed.empty());
+    EXPECT_TRUE(ready);
+    EXPECT_TRUE(finished[count]);
+}
+
+TEST(Scheduler, Failure)
+{
+    /* Dependents of a failed job never start. */
+    std::vector<std::vector<size_t>> dependencies = { { }, { 0 }, { 1 } };
+
+    std::atomic<size_t> ran(0);
+    std::vector<size_t> failed = Scheduler(2).run(dependencies, [&](size_t job) {
+        ran++;
+        return (job != 1);
+    });
+
+    EXPECT_EQ(std::vector<size_t>({ 1 }), failed);
+    EXPECT_EQ(2, ran.load());
+}
+
+TEST(Scheduler, Empty)
+{
+    std::vector<size_t> failed = Scheduler(4).run({ }, [](size_t job) {
+        return false;
+    });
+    EXPECT_TRUE(failed.empty());
+}
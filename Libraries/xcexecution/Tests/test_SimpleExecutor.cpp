@@ -9,6 +9,7 @@
 
 #include <gtest/gtest.h>
 #include <xcexecution/SimpleExecutor.h>
+#include <xcexecution/BuildDatabase.h>
 #include <xcformatter/NullFormatter.h>
 #include <pbxbuild/Tool/Invocation.h>
 #include <builtin/Driver.h>
@@ -18,6 +19,7 @@
 #include <libutil/MemoryFilesystem.h>
 
 using xcexecution::SimpleExecutor;
+using xcexecution::BuildDatabase;
 using libutil::Filesystem;
 using libutil::MemoryFilesystem;
 
@@ -91,51 +93,142 @@ TEST(SimpleExecutor, PropagateToolResult)
     /* Create test executor. */
     auto formatter = xcformatter::NullFormatter::Create();
     std::vector<std::string> const executablePaths = { filesystem.path("") };
-    SimpleExecutor executor = SimpleExecutor(formatter, false, registry);
-
-    /* Succeed if all tools succeed. */
-    auto success = executor.performInvocations(
-        &context,
-        &launcher,
-        &filesystem,
-        executablePaths,
-        {
-            builtinSuccess,
-            externalSuccess,
-        },
-        false);
-    ASSERT_TRUE(success.first);
-    EXPECT_EQ(success.second.size(), 0);
-
-    /* Fail if a tool fails. */
-    auto fail1 = executor.performInvocations(
-        &context,
-        &launcher,
-        &filesystem,
-        executablePaths,
-        {
-            externalFail,
-            builtinSuccess,
-            externalSuccess,
-        },
-        false);
-    ASSERT_FALSE(fail1.first);
-    EXPECT_EQ(fail1.second.size(), 1);
-
-    /* Fail if a tool fails, even if not first. */
-    auto fail2 = executor.performInvocations(
-        &context,
-        &launcher,
-        &filesystem,
-        executablePaths,
-        {
-            builtinSuccess,
-            builtinFail,
-            externalSuccess,
-            externalFail,
-        },
-        false);
-    ASSERT_FALSE(fail2.first);
-    EXPECT_EQ(fail2.second.size(), 1);
+    SimpleExecutor executor(formatter, false, registry);
+
+    std::mutex outputMutex;
+
+    /* Succeed if the tool succeeds. */
+    EXPECT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, builtinSuccess, false, &outputMutex, nullptr));
+    EXPECT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, externalSuccess, false, &outputMutex, nullptr));
+
+    /* Fail if the tool fails. */
+    EXPECT_FALSE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, builtinFail, false, &outputMutex, nullptr));
+    EXPECT_FALSE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, externalFail, false, &outputMutex, nullptr));
 }
 
+TEST(SimpleExecutor, ActionCache)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("tool", std::vector<uint8_t>()),
+        MemoryFilesystem::Entry::File("input", std::vector<uint8_t>({ 'i' })),
+    });
+
+    /* The tool writes its output, and counts how often it ran. */
+    int runs = 0;
+    auto launcher = process::MemoryLauncher({
+        { filesystem.path("tool"), [&](Filesystem *filesystem, process::Context const *context) -> ext::optional<int> {
+            runs++;
+            return (filesystem->write(std::vector<uint8_t>({ 'o' }), context->commandLineArguments().front()) ? 0 : 1);
+        } },
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::External("tool");
+    invocation.arguments() = { filesystem.path("output") };
+    invocation.inputs() = { filesystem.path("input") };
+    invocation.outputs() = { filesystem.path("output") };
+
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    SimpleExecutor executor(formatter, false, builtin::Registry::Create({ }), 1, false, false, filesystem.path("cache"));
+    std::mutex outputMutex;
+
+    /* First run is a miss. */
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, nullptr));
+    EXPECT_EQ(1, runs);
+
+    /* With the same inputs, the output is restored without running. */
+    ASSERT_TRUE(filesystem.removeFile(filesystem.path("output")));
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, nullptr));
+    EXPECT_EQ(1, runs);
+    EXPECT_TRUE(filesystem.exists(filesystem.path("output")));
+
+    /* Changed inputs run again. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>({ 'c' }), filesystem.path("input")));
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, nullptr));
+    EXPECT_EQ(2, runs);
+
+    /* An updated tool runs again. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>({ 't' }), filesystem.path("tool")));
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, nullptr));
+    EXPECT_EQ(3, runs);
+
+    /* So does a tool given a different process environment. */
+    auto environmentContext = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>({ { "VARIABLE", "value" } }));
+    ASSERT_TRUE(executor.performInvocation(&environmentContext, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, nullptr));
+    EXPECT_EQ(4, runs);
+}
+
+TEST(SimpleExecutor, DiscoveredInputChangedWhileRunning)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("tool", std::vector<uint8_t>()),
+        MemoryFilesystem::Entry::File("input", std::vector<uint8_t>({ 'i' })),
+        MemoryFilesystem::Entry::File("header", std::vector<uint8_t>({ 'h' })),
+    });
+    std::string output = filesystem.path("output");
+    std::string dependencies = filesystem.path("output.d");
+    std::string header = filesystem.path("header");
+
+    /* The tool reports reading a header in its dependency info, and edits it on the first run. */
+    int runs = 0;
+    auto launcher = process::MemoryLauncher({
+        { filesystem.path("tool"), [&](Filesystem *filesystem, process::Context const *context) -> ext::optional<int> {
+            runs++;
+            if (runs == 1 && !filesystem->write(std::vector<uint8_t>({ 'e' }), header)) {
+                return 1;
+            }
+
+            std::string makefile = output + ": " + filesystem->resolvePath(header) + "\n";
+            bool written = filesystem->write(std::vector<uint8_t>({ 'o' }), output) && filesystem->write(std::vector<uint8_t>(makefile.begin(), makefile.end()), dependencies);
+            return (written ? 0 : 1);
+        } },
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::External("tool");
+    invocation.workingDirectory() = filesystem.path("");
+    invocation.inputs() = { filesystem.path("input") };
+    invocation.outputs() = { output };
+    invocation.dependencyInfo() = { pbxbuild::Tool::Invocation::DependencyInfo(dependency::DependencyInfoFormat::Makefile, dependencies) };
+
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    SimpleExecutor executor(formatter, false, builtin::Registry::Create({ }), 1, false, false, filesystem.path("cache"));
+    BuildDatabase database;
+    std::mutex outputMutex;
+
+    /* The header changed after the tool started, so the output is neither recorded nor cached. */
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, &database));
+    EXPECT_EQ(1, runs);
+
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, &database));
+    EXPECT_EQ(2, runs);
+
+    /* Without changes while running, the next build is up to date. */
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, &database));
+    EXPECT_EQ(2, runs);
+
+    /* And the output can be restored from the action cache. */
+    BuildDatabase empty;
+    ASSERT_TRUE(filesystem.removeFile(output));
+    ASSERT_TRUE(executor.performInvocation(&context, &launcher, &filesystem, executablePaths, invocation, false, &outputMutex, &empty));
+    EXPECT_EQ(2, runs);
+    EXPECT_TRUE(filesystem.exists(output));
+}